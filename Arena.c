@@ -0,0 +1,95 @@
+#include "Arena.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+Arena fresh_arena(void);
+bool reserve(Arena *, size_t size);
+void *arena_alloc(Arena *, size_t size);
+void *arena_alloc_zeroed(Arena *, size_t size);
+void reset(Arena *);
+void free_arena(Arena *);
+
+const ArenaFunctions arena_functions = {
+    .fresh_arena=fresh_arena,
+    .reserve=reserve,
+    .alloc=arena_alloc,
+    .alloc_zeroed=arena_alloc_zeroed,
+    .reset=reset,
+    .free=free_arena
+};
+
+// returns pointer to the handler for arena functions
+const ArenaFunctions *get_arena_functions() {
+    return &arena_functions;
+}
+
+// gives an arena with no memory yet
+Arena fresh_arena(void) {
+    return (Arena){ .block=NULL, .memory=NULL, .size=0, .used=0, .dirty=0 };
+}
+
+// makes sure an empty arena can hand out "size" bytes, replacing its memory
+// with a bigger block if not. Returns false if the arena is not empty or
+// there is not enough memory.
+bool reserve(Arena *arena, size_t size) {
+    size = ARENA_ROUND(size);
+    if (arena->used != 0) {
+        return false;
+    }
+    if (size <= arena->size) {
+        return true;
+    }
+    free(arena->block);
+    // memory from calloc costs nothing until it is touched, and is known to
+    // be zero, so a big table that has to start out zero is cheap to take
+    arena->block = calloc(1, size + ARENA_ALIGN);
+    if (arena->block == NULL) {
+        arena->memory = NULL;
+        arena->size = arena->dirty = 0;
+        return false;
+    }
+    arena->memory = (unsigned char *)ARENA_ROUND((uintptr_t)arena->block);
+    arena->size = size;
+    arena->dirty = 0;
+    return true;
+}
+
+// hands out "size" bytes. Returns NULL if the arena is full.
+void *arena_alloc(Arena *arena, size_t size) {
+    size = ARENA_ROUND(size);
+    if (size > arena->size - arena->used) {
+        return NULL;
+    }
+    void *p = arena->memory + arena->used;
+    arena->used += size;
+    if (arena->used > arena->dirty) {
+        arena->dirty = arena->used;
+    }
+    return p;
+}
+
+// hands out "size" bytes set to zero. Only the part that was handed out
+// before has to be cleared. Returns NULL if the arena is full.
+void *arena_alloc_zeroed(Arena *arena, size_t size) {
+    size_t dirty = arena->dirty;
+    unsigned char *p = arena_alloc(arena, size);
+    if (p && (size_t)(p - arena->memory) < dirty) {
+        size_t dirty_bytes = dirty - (size_t)(p - arena->memory);
+        memset(p, 0, dirty_bytes < size ? dirty_bytes : size);
+    }
+    return p;
+}
+
+// takes back everything the arena handed out, keeping its memory
+void reset(Arena *arena) {
+    arena->used = 0;
+}
+
+// frees the arena's memory, leaving it empty
+void free_arena(Arena *arena) {
+    free(arena->block);
+    *arena = fresh_arena();
+}
@@ -0,0 +1,37 @@
+#ifndef __ARENA_H__
+#define __ARENA_H__
+#include <stdbool.h>
+#include <stddef.h>
+
+// every allocation from an arena starts on a cache line, so memory used by
+// different threads never shares one
+#define ARENA_ALIGN 64
+// the room an allocation of "size" bytes takes up in an arena
+#define ARENA_ROUND(size) (((size) + ARENA_ALIGN-1) & ~(size_t)(ARENA_ALIGN-1))
+
+// a bump allocator over one block of memory, for everything a search needs.
+// Allocating moves a pointer forward and nothing is freed on its own: a reset
+// hands the whole block out again for the next search, so after the first
+// search a reused arena never calls malloc or free. Not thread safe; take
+// what each thread needs before starting them.
+typedef struct {
+    void *block;            // as allocated, to free
+    unsigned char *memory;  // the start of "block", aligned
+    size_t size;   // bytes in "memory"
+    size_t used;   // bytes handed out since the last reset
+    size_t dirty;  // bytes ever handed out from "memory", past which it is still zero
+} Arena;
+
+// handler struct for arenas
+typedef struct {
+    Arena (*fresh_arena)(void);
+    bool (*reserve)(Arena *, size_t size);
+    void *(*alloc)(Arena *, size_t size);
+    void *(*alloc_zeroed)(Arena *, size_t size);
+    void (*reset)(Arena *);
+    void (*free)(Arena *);
+} ArenaFunctions;
+
+const ArenaFunctions *get_arena_functions();
+
+#endif /* __ARENA_H__ */
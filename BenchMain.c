@@ -0,0 +1,354 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <math.h>
+
+#include "Board.h"
+#include "Card.h"
+#include "Controls.h"
+#include "Deck.h"
+#include "Draw.h"
+#include "GameState.h"
+#include "Journal.h"
+#include "Latency.h"
+#include "Policy.h"
+#include "Random.h"
+#include "Render.h"
+#include "Simulator.h"
+
+// the recorded games the benchmarks draw their positions from
+#define BENCH_DEALS     4
+#define BENCH_MAX_MOVES 250
+#define MAX_POSITIONS   (BENCH_DEALS * (BENCH_MAX_MOVES+1))
+
+// size of the off-screen grid frames are drawn into
+#define BENCH_LINES 40
+#define BENCH_COLS  80
+
+// a benchmark: "run" performs "iterations" operations on the fixtures
+typedef struct {
+    const char *name;
+    const char *unit;
+    void (*run)(unsigned long iterations);
+} Benchmark;
+
+// timing statistics of one benchmark, in nanoseconds per operation
+typedef struct {
+    unsigned long iterations;
+    double min, median, mean, stddev, max;
+} BenchResult;
+
+// a position along with the move played from it, and the spots that move changes
+typedef struct {
+    Board board;
+    Move move;
+    unsigned int dirty;
+} BenchPosition;
+
+bool parse_args(int argc, char *argv[], unsigned int *num_samples, uint64_t *min_sample_ns, const char **output_file, const char **filter);
+bool setup_fixtures(void);
+BenchResult run_benchmark(const Benchmark *benchmark, unsigned int num_samples, uint64_t min_sample_ns);
+void write_result(FILE *file, const Benchmark *benchmark, BenchResult result, unsigned int num_samples, bool last);
+void bench_shuffle(unsigned long iterations);
+void bench_flip(unsigned long iterations);
+void bench_move_to_stack(unsigned long iterations);
+void bench_add_remove(unsigned long iterations);
+void bench_is_stackable_regular(unsigned long iterations);
+void bench_lowest_visible_index(unsigned long iterations);
+void bench_handle_selection(unsigned long iterations);
+void bench_draw_full(unsigned long iterations);
+void bench_draw_incremental(unsigned long iterations);
+
+const Benchmark benchmarks[] = {
+    { "shuffle",                 "deck",      bench_shuffle },
+    { "flip",                    "flip",      bench_flip },
+    { "move_to_stack",           "move",      bench_move_to_stack },
+    { "add_remove_stack",        "add+remove", bench_add_remove },
+    { "is_stackable_regular",    "pair",      bench_is_stackable_regular },
+    { "lowest_visible_index",    "stack",     bench_lowest_visible_index },
+    { "handle_selection",        "move+undo", bench_handle_selection },
+    { "draw_screen_full",        "frame",     bench_draw_full },
+    { "draw_screen_incremental", "frame",     bench_draw_incremental }
+};
+#define NUM_BENCHMARKS (sizeof(benchmarks) / sizeof(benchmarks[0]))
+
+// fixtures shared by the benchmarks, set up once
+static BenchPosition *positions = NULL;
+static unsigned int num_positions = 0;
+static Deck shuffle_deck, flip_deck;
+static CardStack run_stack, empty_stack;
+static Rng rng;
+static Journal journal;
+static Screen screen;
+// keeps results alive so the work producing them is not thrown away
+static volatile unsigned long sink;
+
+int main(int argc, char *argv[]) {
+    unsigned int num_samples = 10;
+    uint64_t min_sample_ns = 10000000;
+    const char *output_file = NULL, *filter = NULL;
+    if (!parse_args(argc, argv, &num_samples, &min_sample_ns, &output_file, &filter)) {
+        fprintf(stderr, "usage: %s [--samples N] [--min-time-ms N] [--filter NAME] [--output FILE]\n", argv[0]);
+        return 1;
+    }
+    if (!setup_fixtures()) {
+        fprintf(stderr, "%s: out of memory\n", argv[0]);
+        return 1;
+    }
+
+    FILE *file = output_file ? fopen(output_file, "w") : stdout;
+    if (file == NULL) {
+        fprintf(stderr, "%s: could not write %s\n", argv[0], output_file);
+        return 1;
+    }
+    fprintf(file, "{\n  \"samples\": %u,\n  \"positions\": %u,\n  \"benchmarks\": [\n", num_samples, num_positions);
+    const Benchmark *last = NULL;
+    for (unsigned int i = 0; i < NUM_BENCHMARKS; i++) {
+        if (filter == NULL || strstr(benchmarks[i].name, filter)) {
+            last = &benchmarks[i];
+        }
+    }
+    for (unsigned int i = 0; i < NUM_BENCHMARKS; i++) {
+        if (filter && !strstr(benchmarks[i].name, filter)) {
+            continue;
+        }
+        BenchResult result = run_benchmark(&benchmarks[i], num_samples, min_sample_ns);
+        write_result(file, &benchmarks[i], result, num_samples, &benchmarks[i] == last);
+        // progress goes to stderr so the JSON stays clean
+        fprintf(stderr, "%-24s %10.1f ns/%s\n", benchmarks[i].name, result.median, benchmarks[i].unit);
+    }
+    fprintf(file, "  ]\n}\n");
+    if (output_file) {
+        fclose(file);
+    }
+
+    get_journal_functions()->free(&journal);
+    get_memory_render_functions()->free();
+    free(positions);
+    return 0;
+}
+
+// reads the command line options. Returns false if they are not valid.
+bool parse_args(int argc, char *argv[], unsigned int *num_samples, uint64_t *min_sample_ns, const char **output_file, const char **filter) {
+    for (int i = 1; i < argc; i++) {
+        char *end = "";
+        if (i+1 >= argc) {
+            return false;
+        }
+        if (strcmp(argv[i], "--samples") == 0) {
+            *num_samples = strtoul(argv[++i], &end, 10);
+            if (*num_samples == 0) {
+                return false;
+            }
+        } else if (strcmp(argv[i], "--min-time-ms") == 0) {
+            *min_sample_ns = strtoull(argv[++i], &end, 10) * 1000000;
+        } else if (strcmp(argv[i], "--filter") == 0) {
+            *filter = argv[++i];
+        } else if (strcmp(argv[i], "--output") == 0) {
+            *output_file = argv[++i];
+        } else {
+            return false;
+        }
+        if (*end != '\0') {
+            return false;
+        }
+    }
+    return true;
+}
+
+// records the games the positions come from, and sets up the decks, stacks and
+// off-screen grid. Returns false if memory runs out.
+bool setup_fixtures(void) {
+    const SimulatorFunctions *sfuncs = get_simulator_functions();
+    const Policy *policy = get_policy_functions()->find("heuristic");
+
+    positions = malloc(sizeof(BenchPosition) * MAX_POSITIONS);
+    Board *boards = malloc(sizeof(Board) * (BENCH_MAX_MOVES+1));
+    Move moves[BENCH_MAX_MOVES];
+    if (positions == NULL || boards == NULL || !get_memory_render_functions()->init(BENCH_LINES, BENCH_COLS)) {
+        free(boards);
+        return false;
+    }
+    for (uint64_t deal = 1; deal <= BENCH_DEALS; deal++) {
+        GameResult result = sfuncs->record(deal, policy, BENCH_MAX_MOVES, boards, moves);
+        for (unsigned int i = 0; i < result.num_moves; i++) {
+            unsigned int dirty = moves[i].type == MOVE_FLIP ? SPOT_BIT(DECK_STACK) : SPOT_BIT(moves[i].from) | SPOT_BIT(moves[i].to);
+            positions[num_positions++] = (BenchPosition){ boards[i], moves[i], dirty };
+        }
+    }
+    free(boards);
+
+    get_random_functions()->seed(&rng, 1);
+    shuffle_deck = get_deck_functions()->fresh_deck();
+    flip_deck = positions[0].board.deck;
+    run_stack = empty_stack = (CardStack){ .num_cards=0 };
+    for (VALUE value = VALUE_KING; value > VALUE_10; value--) {
+        get_stack_functions()->add_to_stack(&run_stack, (Card){ .suit=value % 2 ? SPADE : HEART, .value=value, .is_visible=true });
+    }
+    journal = get_journal_functions()->fresh_journal();
+    get_draw_functions()->set_backend(get_memory_render_functions()->backend);
+    return true;
+}
+
+// returns the time in nanoseconds "iterations" operations take
+static uint64_t time_run(const Benchmark *benchmark, unsigned long iterations) {
+    const LatencyFunctions *lfuncs = get_latency_functions();
+    uint64_t start = lfuncs->now();
+    benchmark->run(iterations);
+    return lfuncs->now() - start;
+}
+// sorts sample times for the median
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// runs a benchmark: first doubles the iterations per sample until a sample
+// takes "min_sample_ns", then times "num_samples" samples of that many
+BenchResult run_benchmark(const Benchmark *benchmark, unsigned int num_samples, uint64_t min_sample_ns) {
+    BenchResult result = { .iterations = 1 };
+    while (time_run(benchmark, result.iterations) < min_sample_ns && result.iterations < (1ul << 40)) {
+        result.iterations *= 2;
+    }
+
+    double *samples = malloc(sizeof(double) * num_samples);
+    if (samples == NULL) {
+        return result;
+    }
+    double total = 0;
+    for (unsigned int i = 0; i < num_samples; i++) {
+        samples[i] = (double)time_run(benchmark, result.iterations) / result.iterations;
+        total += samples[i];
+    }
+    qsort(samples, num_samples, sizeof(double), compare_doubles);
+    result.min = samples[0];
+    result.max = samples[num_samples-1];
+    result.median = num_samples % 2 ? samples[num_samples/2] : (samples[num_samples/2-1] + samples[num_samples/2]) / 2;
+    result.mean = total / num_samples;
+    double squares = 0;
+    for (unsigned int i = 0; i < num_samples; i++) {
+        squares += (samples[i] - result.mean) * (samples[i] - result.mean);
+    }
+    result.stddev = sqrt(squares / num_samples);
+    free(samples);
+    return result;
+}
+
+// writes one benchmark's results as a JSON object
+void write_result(FILE *file, const Benchmark *benchmark, BenchResult result, unsigned int num_samples, bool last) {
+    fprintf(file, "    {\"name\": \"%s\", \"unit\": \"%s\", \"iterations\": %lu, \"samples\": %u, "
+            "\"ns_per_op\": {\"min\": %.2f, \"median\": %.2f, \"mean\": %.2f, \"stddev\": %.2f, \"max\": %.2f}}%s\n",
+            benchmark->name, benchmark->unit, result.iterations, num_samples,
+            result.min, result.median, result.mean, result.stddev, result.max, last ? "" : ",");
+}
+
+// shuffles a whole deck
+void bench_shuffle(unsigned long iterations) {
+    const DeckFunctions *dfuncs = get_deck_functions();
+    for (unsigned long i = 0; i < iterations; i++) {
+        dfuncs->shuffle(&shuffle_deck, &rng);
+    }
+    sink = shuffle_deck.cards[0].value;
+}
+// flips through the deck of a fresh deal, recycling the discard pile each time it runs out
+void bench_flip(unsigned long iterations) {
+    const DeckFunctions *dfuncs = get_deck_functions();
+    for (unsigned long i = 0; i < iterations; i++) {
+        dfuncs->flip(&flip_deck);
+    }
+    sink = flip_deck.num_cards;
+}
+// moves a run of three face up cards onto an empty stack and back
+void bench_move_to_stack(unsigned long iterations) {
+    const CardStackFunctions *sfuncs = get_stack_functions();
+    for (unsigned long i = 0; i < iterations; i++) {
+        if (i % 2) {
+            sfuncs->move_to_stack(&run_stack, &empty_stack, 0);
+        } else {
+            sfuncs->move_to_stack(&empty_stack, &run_stack, 0);
+        }
+    }
+    if (iterations % 2) {
+        sfuncs->move_to_stack(&run_stack, &empty_stack, 0);
+    }
+    sink = run_stack.num_cards;
+}
+// adds a card to a stack and takes it off again
+void bench_add_remove(unsigned long iterations) {
+    const CardStackFunctions *sfuncs = get_stack_functions();
+    unsigned long total = 0;
+    for (unsigned long i = 0; i < iterations; i++) {
+        sfuncs->add_to_stack(&empty_stack, run_stack.cards[i % run_stack.num_cards]);
+        total += sfuncs->remove_from_stack(&empty_stack).value;
+    }
+    sink = total;
+}
+// checks whether one card can go on another, across every pair of cards
+void bench_is_stackable_regular(unsigned long iterations) {
+    const CardFunctions *cfuncs = get_card_functions();
+    unsigned long total = 0;
+    for (unsigned long i = 0; i < iterations; i++) {
+        unsigned int pair = i % (NUM_CARDS * NUM_CARDS);
+        Card old_card = { .suit = pair / NUM_CARDS / NUM_VALUES, .value = pair / NUM_CARDS % NUM_VALUES, .is_visible = true };
+        Card new_card = { .suit = pair % NUM_CARDS / NUM_VALUES, .value = pair % NUM_VALUES, .is_visible = true };
+        total += cfuncs->is_stackable_regular(old_card, new_card);
+    }
+    sink = total;
+}
+// finds the first face up card of the working stacks of the recorded positions
+void bench_lowest_visible_index(unsigned long iterations) {
+    const CardStackFunctions *sfuncs = get_stack_functions();
+    unsigned long total = 0;
+    for (unsigned long i = 0; i < iterations; i++) {
+        const Board *board = &positions[i / NUM_WORKING_STACKS % num_positions].board;
+        total += sfuncs->lowest_visible_index(&board->working_stacks[i % NUM_WORKING_STACKS]);
+    }
+    sink = total;
+}
+// plays the recorded moves with the selection handler as the player would:
+// the source is selected, the cursor is on the target and space is pressed.
+// Each move is taken back again so the positions stay as recorded.
+void bench_handle_selection(unsigned long iterations) {
+    const ControlFunctions *cfuncs = get_control_functions();
+    const JournalFunctions *jfuncs = get_journal_functions();
+    unsigned long total = 0;
+    for (unsigned long i = 0; i < iterations; i++) {
+        BenchPosition *position = &positions[i % num_positions];
+        if (position->move.type == MOVE_FLIP) {
+            continue;
+        }
+        GameState state = { .spot = position->move.to, .index = 0, .saved_spot = position->move.from,
+                            .saved_index = position->move.index, .help_menu_up = false, .latency_hud_up = false,
+                            .hint_up = false, .hint_from = NO_SPOT, .hint_to = NO_SPOT, .hint_index = 0, .winnable = WINNABLE_NONE, .dirty = 0 };
+        cfuncs->selection(&position->board, &journal, &state);
+        total += jfuncs->undo(&journal, &position->board);
+    }
+    sink = total;
+}
+// draws the whole screen for each recorded position
+void bench_draw_full(unsigned long iterations) {
+    const DrawFunctions *dfuncs = get_draw_functions();
+    for (unsigned long i = 0; i < iterations; i++) {
+        GameState state = { .spot = WORKING_0, .index = 0, .saved_spot = NO_SPOT, .saved_index = 0,
+                            .help_menu_up = false, .latency_hud_up = false,
+                            .hint_up = false, .hint_from = NO_SPOT, .hint_to = NO_SPOT, .hint_index = 0, .winnable = WINNABLE_NONE, .dirty = DIRTY_SCREEN };
+        dfuncs->screen(&positions[i % num_positions].board, &state, &screen);
+    }
+    sink = screen.frames;
+}
+// draws only the spots the move into each recorded position changed
+void bench_draw_incremental(unsigned long iterations) {
+    const DrawFunctions *dfuncs = get_draw_functions();
+    for (unsigned long i = 0; i < iterations; i++) {
+        unsigned int index = i % num_positions;
+        GameState state = { .spot = WORKING_0, .index = 0, .saved_spot = NO_SPOT, .saved_index = 0,
+                            .help_menu_up = false, .latency_hud_up = false,
+                            .hint_up = false, .hint_from = NO_SPOT, .hint_to = NO_SPOT, .hint_index = 0, .winnable = WINNABLE_NONE,
+                            .dirty = index ? positions[index-1].dirty : DIRTY_SCREEN };
+        dfuncs->screen(&positions[index].board, &state, &screen);
+    }
+    sink = screen.frames;
+}
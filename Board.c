@@ -0,0 +1,221 @@
+#include "Board.h"
+#include "Card.h"
+#include "Deck.h"
+#include "GameState.h"
+#include "Random.h"
+#include "Zobrist.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+Board get_fresh_board(void);
+void deal(Board *, uint64_t deal_number);
+bool is_legal(const Board *, Move);
+bool apply_move(Board *, Move);
+bool is_won(const Board *);
+bool auto_complete_move(const Board *, Move *);
+
+const BoardFunctions board_functions = {
+    .fresh_board=get_fresh_board,
+    .deal=deal,
+    .is_legal=is_legal,
+    .apply_move=apply_move,
+    .is_won=is_won,
+    .auto_complete_move=auto_complete_move
+};
+
+// returns pointer to the handler for board functions
+const BoardFunctions *get_board_functions() {
+    return &board_functions;
+}
+
+// gives a board with an ordered deck and empty stacks
+Board get_fresh_board(void) {
+    Board board = { .deck=get_deck_functions()->fresh_deck() };
+    for (int i = 0; i < NUM_SOLUTION_STACKS; i++) {
+        board.solution_stacks[i].num_cards = 0;
+    }
+    for (int i = 0; i < NUM_WORKING_STACKS; i++) {
+        board.working_stacks[i].num_cards = 0;
+    }
+    return board;
+}
+
+// shuffles the deck and deals the working stacks from it, turning the top
+// card of each working stack face up. The same deal number always gives the
+// same deal.
+void deal(Board *board, uint64_t deal_number) {
+    const DeckFunctions      *dfuncs = get_deck_functions();
+    const CardStackFunctions *sfuncs = get_stack_functions();
+
+    Rng rng;
+    get_random_functions()->seed(&rng, deal_number);
+    dfuncs->shuffle(&board->deck, &rng);
+
+    for (int i = NUM_WORKING_STACKS-1; i >= 0; i--) {
+        for (int j = i; j < NUM_WORKING_STACKS; j++) {
+            Card c = dfuncs->remove_card(&board->deck);
+            c.is_visible = false;
+            sfuncs->add_to_stack(&board->working_stacks[j], c);
+        }
+    }
+    for (int i = 0; i < NUM_WORKING_STACKS; i++) {
+        CardStack *stack = &board->working_stacks[i];
+        sfuncs->set_visible(stack, stack->num_cards-1, true);
+    }
+    assert(get_zobrist_functions()->is_consistent(board));
+}
+
+// returns whether or not the spot is one of the solution stacks
+static bool is_solution_spot(SELECTED_SPOT spot) {
+    return spot >= SOLUTION_0 && spot <= SOLUTION_3;
+}
+// returns whether or not the spot is one of the working stacks
+static bool is_working_spot(SELECTED_SPOT spot) {
+    return spot >= WORKING_0 && spot <= WORKING_6;
+}
+
+// finds the card the move would pick up, i.e. the lowest card moved. Returns
+// false if there is no card there that can be picked up.
+static bool source_card(const Board *board, Move move, Card *card) {
+    if (move.from == DECK_STACK) {
+        if (board->deck.num_cards_discard == 0) {
+            return false;
+        }
+        *card = board->deck.discard[board->deck.num_cards_discard-1];
+        return true;
+    }
+    if (is_solution_spot(move.from)) {
+        const CardStack *stack = &board->solution_stacks[move.from-SOLUTION_0];
+        if (stack_is_empty(stack)) {
+            return false;
+        }
+        *card = stack_top(stack);
+        return true;
+    }
+    if (is_working_spot(move.from)) {
+        const CardStack *stack = &board->working_stacks[move.from-WORKING_0];
+        if (move.index >= stack->num_cards || !stack->cards[move.index].is_visible) {
+            return false;
+        }
+        *card = stack->cards[move.index];
+        return true;
+    }
+    return false;
+}
+
+// returns whether or not the move is allowed on the given board
+bool is_legal(const Board *board, Move move) {
+
+    if (move.type == MOVE_FLIP) {
+        return get_deck_functions()->can_flip(&board->deck);
+    }
+
+    Card card;
+    if (move.from == move.to || !source_card(board, move, &card)) {
+        return false;
+    }
+
+    if (is_solution_spot(move.to)) {
+        const CardStack *to_stack = &board->solution_stacks[move.to-SOLUTION_0];
+        // only single cards go onto solution stacks, and never from another one
+        if (is_solution_spot(move.from)) {
+            return false;
+        }
+        if (is_working_spot(move.from)
+                && move.index != stack_highest_visible_index(&board->working_stacks[move.from-WORKING_0])) {
+            return false;
+        }
+        if (stack_is_empty(to_stack)) {
+            return card.value == VALUE_ACE;
+        }
+        return card_fits_solution(stack_top(to_stack), card);
+    }
+
+    if (is_working_spot(move.to)) {
+        const CardStack *to_stack = &board->working_stacks[move.to-WORKING_0];
+        if (stack_is_empty(to_stack)) {
+            return card.value == VALUE_KING;
+        }
+        return card_fits_regular(stack_top(to_stack), card);
+    }
+
+    return false;
+}
+
+// applies the move to the board if it is legal. Returns whether or not it was applied.
+bool apply_move(Board *board, Move move) {
+    const DeckFunctions      *dfuncs = get_deck_functions();
+    const CardStackFunctions *sfuncs = get_stack_functions();
+
+    if (!is_legal(board, move)) {
+        return false;
+    }
+    if (move.type == MOVE_FLIP) {
+        dfuncs->flip(&board->deck);
+        assert(get_zobrist_functions()->is_consistent(board));
+        return true;
+    }
+
+    CardStack *to_stack = is_solution_spot(move.to)
+        ? &board->solution_stacks[move.to-SOLUTION_0]
+        : &board->working_stacks[move.to-WORKING_0];
+
+    if (move.from == DECK_STACK) {
+        Card card = dfuncs->remove_from_stack(&board->deck);
+        card.is_visible = true;
+        sfuncs->add_to_stack(to_stack, card);
+    } else if (is_solution_spot(move.from)) {
+        CardStack *from_stack = &board->solution_stacks[move.from-SOLUTION_0];
+        sfuncs->move_to_stack(to_stack, from_stack, from_stack->num_cards-1);
+    } else {
+        sfuncs->move_to_stack(to_stack, &board->working_stacks[move.from-WORKING_0], move.index);
+    }
+    // the hashes the board carries must match a rehash after every move
+    assert(get_zobrist_functions()->is_consistent(board));
+    return true;
+}
+
+// returns whether or not every card has made it to the solution stacks
+bool is_won(const Board *board) {
+    for (int i = 0; i < NUM_SOLUTION_STACKS; i++) {
+        if (board->solution_stacks[i].num_cards != NUM_VALUES) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// finds the next move of the sweep that finishes the game once the deck and
+// discard pile are empty and every card is face up, when all that is left is
+// putting the cards on the solution stacks. The lowest card goes first.
+// Returns false if the game is not at that point, or is already won.
+bool auto_complete_move(const Board *board, Move *move) {
+    if (board->deck.num_cards || board->deck.num_cards_discard) {
+        return false;
+    }
+    int lowest = -1;
+    for (int i = 0; i < NUM_WORKING_STACKS; i++) {
+        const CardStack *stack = &board->working_stacks[i];
+        if (stack->num_cards == 0) {
+            continue;
+        }
+        if (stack_lowest_visible_index(stack) != 0 || !stack->cards[0].is_visible) {
+            return false;
+        }
+        if (lowest < 0 || stack_top(stack).value < stack_top(&board->working_stacks[lowest]).value) {
+            lowest = i;
+        }
+    }
+    if (lowest < 0) {
+        return false;
+    }
+    for (int i = 0; i < NUM_SOLUTION_STACKS; i++) {
+        *move = (Move){ .type=MOVE_CARDS, .from=WORKING_0+lowest, .to=SOLUTION_0+i,
+                        .index=board->working_stacks[lowest].num_cards-1 };
+        if (is_legal(board, *move)) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,45 @@
+#ifndef __BOARD_H__
+#define __BOARD_H__
+#include <stdbool.h>
+#include <stdint.h>
+#include "Card.h"
+#include "Deck.h"
+#include "GameState.h"
+
+#define NUM_SOLUTION_STACKS 4
+#define NUM_WORKING_STACKS  7
+
+// a full game position: the deck and discard pile, the four solution stacks
+// and the seven working stacks. Holds no cursor or display state.
+typedef struct {
+    Deck deck;
+    CardStack solution_stacks[NUM_SOLUTION_STACKS];
+    CardStack working_stacks[NUM_WORKING_STACKS];
+} Board;
+
+typedef enum { MOVE_FLIP, MOVE_CARDS } MOVE_TYPE;
+
+// a single move on the board. For MOVE_CARDS, cards are moved from the "from"
+// spot to the "to" spot, and "index" is the index of the lowest card moved out
+// of a working stack. "index" is ignored for the deck and solution stacks, as
+// only their top card can be moved. "from" and "to" are ignored for MOVE_FLIP.
+typedef struct {
+    MOVE_TYPE type;
+    SELECTED_SPOT from;
+    SELECTED_SPOT to;
+    unsigned int index;
+} Move;
+
+// handler struct for all functions implementing the rules of the game
+typedef struct {
+    Board (*fresh_board)(void);
+    void (*deal)(Board *, uint64_t deal_number);
+    bool (*is_legal)(const Board *, Move);
+    bool (*apply_move)(Board *, Move);
+    bool (*is_won)(const Board *);
+    bool (*auto_complete_move)(const Board *, Move *);
+} BoardFunctions;
+
+const BoardFunctions *get_board_functions();
+
+#endif /* __BOARD_H__ */
@@ -1,11 +1,10 @@
 #include "Card.h"
 #include "GameState.h"
-#include <ncursesw/ncurses.h>
+#include "Zobrist.h"
 #include <locale.h>
+#include <pthread.h>
 
 // card functions
-void draw_card(Card, int y, int x, bool, int color);
-void draw_blank_card(int y, int x);
 void print_card(Card);
 const int *suit_string(SUIT);
 const char *value_string(VALUE);
@@ -13,19 +12,21 @@ int is_stackable_regular(Card old_card, Card new_card);
 int is_stackable_solution(Card old_card, Card new_card);
 const char *suit_color(SUIT suit);
 bool equal(Card, Card);
-void draw_empty_card(int y, int x, bool);
 
 // stack functions
 void add_to_stack(CardStack *, Card);
 Card remove_from_stack(CardStack *);
 void move_to_stack(CardStack *to, CardStack *from, unsigned int index);
-Card top(CardStack);
-void draw_stack(CardStack, int y, int x, bool selected_stack, bool saved_stack, GameState state);
-void display_stack(CardStack, int y, int x);
-bool is_empty(CardStack);
-unsigned int highest_visible_index(CardStack);
-unsigned int lowest_visible_index(CardStack);
+void set_visible(CardStack *, unsigned int index, bool is_visible);
+Card top(const CardStack *);
+bool is_empty(const CardStack *);
+unsigned int highest_visible_index(const CardStack *);
+unsigned int lowest_visible_index(const CardStack *);
 void go_to_lowest_stack(CardStack *, CardStack *, GameState *);
+Card top_by_value(CardStack);
+bool is_empty_by_value(CardStack);
+unsigned int highest_visible_index_by_value(CardStack);
+unsigned int lowest_visible_index_by_value(CardStack);
 
 // string constants for suits, colors, and values
 const int *SUIT_STR[5] = { L"♠", L"♦", L"♣", L"♥", NULL };
@@ -44,10 +45,7 @@ const CardFunctions card_functions = {
     .value_string=value_string,
     .is_stackable_regular=is_stackable_regular,
     .is_stackable_solution=is_stackable_solution,
-    .draw=draw_card,
-    .draw_blank=draw_blank_card,
-    .equal=equal,
-    .draw_empty=draw_empty_card
+    .equal=equal
 };
 
 // initializer for card stack function handler
@@ -55,13 +53,16 @@ const CardStackFunctions card_stack_functions = {
     .add_to_stack=add_to_stack,
     .remove_from_stack=remove_from_stack,
     .move_to_stack=move_to_stack,
+    .set_visible=set_visible,
     .top=top,
-    .draw=draw_stack,
-    .display=display_stack,
     .is_empty=is_empty,
     .highest_visible_index=highest_visible_index,
     .lowest_visible_index=lowest_visible_index,
-    .go_to_lowest_stack=go_to_lowest_stack
+    .go_to_lowest_stack=go_to_lowest_stack,
+    .top_by_value=top_by_value,
+    .is_empty_by_value=is_empty_by_value,
+    .highest_visible_index_by_value=highest_visible_index_by_value,
+    .lowest_visible_index_by_value=lowest_visible_index_by_value
 };
 
 // returns string representation of a suit
@@ -74,31 +75,17 @@ const char *value_string(VALUE value) {
 }
 // returns a pointer to the card function handler
 const CardFunctions *get_card_functions() {
-    // set locale so that unicode works
-    setlocale(LC_ALL, "");
     return &card_functions;
 }
 // returns true if new_card can go on top of bottom_card if the bottom_card is
 // on a solution stack
 int is_stackable_solution(Card bottom_card, Card new_card) {
-    return new_card.value == bottom_card.value+1 && new_card.suit == bottom_card.suit;
+    return card_fits_solution(bottom_card, new_card);
 }
 // returns true if new_card can go on top of bottom_card if the bottom_card is
 // on a regular stack
 int is_stackable_regular(Card bottom_card, Card new_card) {
-    if (new_card.value == bottom_card.value-1) {
-        switch(bottom_card.suit) {
-            case DIAMOND:
-            case HEART:
-                return new_card.suit == CLUB || new_card.suit == SPADE;
-            case CLUB:
-            case SPADE:
-                return new_card.suit == DIAMOND || new_card.suit == HEART;
-            default:
-                return false;
-        }
-    }
-    return false;
+    return card_fits_regular(bottom_card, new_card);
 }
 // returns a color string based on suit
 const char *suit_color(SUIT suit) {
@@ -108,72 +95,52 @@ const char *suit_color(SUIT suit) {
         return COLOR_STRS[4];
     }
 }
+// sets the locale from the environment so the suits print as unicode. Done
+// once, on the first card printed, rather than every time the handler is fetched.
+static pthread_once_t locale_once = PTHREAD_ONCE_INIT;
+static void init_locale(void) {
+    setlocale(LC_ALL, "");
+}
 // prints a simple string of the card
 void print_card(Card card) {
+    pthread_once(&locale_once, init_locale);
     printf("%s%s%ls\033[0m", value_string(card.value), suit_color(card.suit), suit_string(card.suit));
 }
-// draws a card on the screen. Takes into account whether or not the color needs to be different.
-void draw_card(Card card, int y, int x, bool selected, int color) {
-    if (!card.is_visible) {
-        draw_blank_card(y, x);
-        return;
-    }
-    if (selected) {
-        attron(COLOR_PAIR(color));
-    }
-    mvprintw(y,   x, "┌────┐");
-    mvprintw(y+1, x, "│");
-    if (selected) {
-        attroff(COLOR_PAIR(color));
-    }
-    printw("%2s", value_string(card.value));
-    if (card.suit == DIAMOND || card.suit == HEART) {
-        attron(COLOR_PAIR(RED));
-    }
-    printw("%ls", suit_string(card.suit));
-    if (card.suit == DIAMOND || card.suit == HEART) {
-        attroff(COLOR_PAIR(RED));
-    }
-    if (selected) {
-        attron(COLOR_PAIR(color));
-    }
-    printw(" │");
-    mvprintw(y+2, x, "│    │");
-    mvprintw(y+3, x, "└────┘");
-    if (selected) {
-        attroff(COLOR_PAIR(color));
-    }
-}
-// draws a blank card
-void draw_blank_card(int y, int x) {
-    mvprintw(y,   x, "┌────┐");
-    mvprintw(y+1, x, "│♠  ♦│");
-    mvprintw(y+2, x, "│♥  ♣│");
-    mvprintw(y+3, x, "└────┘");
-}
-
 // adds a card to the stack
 void add_to_stack(CardStack *stack, Card card) {
+    stack->hash ^= zobrist_card_key(ZOBRIST_STACK, stack->num_cards, card);
     stack->cards[stack->num_cards++] = card;
 }
 // removes a card from the stack and returns it
 Card remove_from_stack(CardStack *stack) {
-    return stack->cards[stack->num_cards--];
+    Card card = stack->cards[--stack->num_cards];
+    stack->hash ^= zobrist_card_key(ZOBRIST_STACK, stack->num_cards, card);
+    return card;
 }
 // move cards from "index" to the end from the "from" stack to the "to" stack
 void move_to_stack(CardStack *to, CardStack *from, unsigned int index) {
     for (int i = index; i < from->num_cards; i++) {
+        from->hash ^= zobrist_card_key(ZOBRIST_STACK, i, from->cards[i]);
         add_to_stack(to, from->cards[i]);
     }
     from->num_cards = index;
 
     if (index > 0) {
-        from->cards[index-1].is_visible = true;
+        set_visible(from, index-1, true);
+    }
+}
+// turns the card at "index" of the stack face up or face down
+void set_visible(CardStack *stack, unsigned int index, bool is_visible) {
+    Card *card = &stack->cards[index];
+    if (card->is_visible != is_visible) {
+        stack->hash ^= zobrist_card_key(ZOBRIST_STACK, index, *card);
+        card->is_visible = is_visible;
+        stack->hash ^= zobrist_card_key(ZOBRIST_STACK, index, *card);
     }
 }
 // returns whatever card is at the top of the stack
-Card top(CardStack stack) {
-    return stack.cards[stack.num_cards-1];
+Card top(const CardStack *stack) {
+    return stack_top(stack);
 }
 // returns a pointer to the handler for the stack functions
 const CardStackFunctions *get_stack_functions() {
@@ -183,82 +150,42 @@ const CardStackFunctions *get_stack_functions() {
 bool equal(Card card1, Card card2) {
     return card1.suit == card2.suit && card1.value == card2.value;
 }
-// draws the stack on the screen
-void draw_stack(CardStack stack, int y, int x, bool selected_stack, bool saved_stack, GameState state) {
-    const CardFunctions *cfuncs = get_card_functions();
-    if (stack.num_cards == 0) {
-        cfuncs->draw_empty(y, x, selected_stack);
-        return;
-    }
-
-    for (int i = 0, row = 0; i < stack.num_cards; i++) {
-        bool selected = selected_stack && state.index == i;
-        bool saved_selected = saved_stack && state.saved_index == i;
-        int color = RESET;
-        if (selected) {
-            color = GREEN;
-        } else if (saved_selected) {
-            color = YELLOW;
-        }
-        cfuncs->draw(stack.cards[i], y+row, x, selected || saved_selected, color);
-        if (stack.cards[i].is_visible) {
-            row += 2;
-        } else {
-            row += 1;
-        }
-    }
-}
-// draws an empty card spot
-void draw_empty_card(int y, int x, bool selected) {
-    if (selected) {
-        attron(COLOR_PAIR(GREEN));
-    }
-    mvprintw(y,   x, "┌────┐");
-    mvprintw(y+1, x, "│ ╲╱ │");
-    mvprintw(y+2, x, "│ ╱╲ │");
-    mvprintw(y+3, x, "└────┘");
-    if (selected) {
-        attroff(COLOR_PAIR(GREEN));
-    }
-}
 // returns whether or not a stack is empty
-bool is_empty(CardStack stack) {
-    return stack.num_cards == 0;
+bool is_empty(const CardStack *stack) {
+    return stack_is_empty(stack);
 }
 // returns the highest index of all visible cards in the stack
-unsigned int highest_visible_index(CardStack stack) {
-    return stack.num_cards-1;
+unsigned int highest_visible_index(const CardStack *stack) {
+    return stack_highest_visible_index(stack);
 }
 // returns the lowest index of all visible cards in the stack
-unsigned int lowest_visible_index(CardStack stack) {
-    if (is_empty(stack)) {
-        return 0;
-    }
-    for (int i = 0; i < stack.num_cards; i++) {
-        if (stack.cards[i].is_visible) {
-            return i;
-        }
-    }
-    return stack.num_cards-1;
-}
-// displays the contents of the stack at given x y coordinates
-void display_stack(CardStack stack, int y, int x) {
-    const CardFunctions *cfuncs = get_card_functions();
-    mvprintw(y, x, "Num cards: %d", stack.num_cards);
-    for (int i = 0; i < stack.num_cards; i++) {
-        cfuncs->draw(stack.cards[i], y+1, x+i*6, false, RESET);
-    }
+unsigned int lowest_visible_index(const CardStack *stack) {
+    return stack_lowest_visible_index(stack);
 }
 // finds the ordinally lowest working stack
 void go_to_lowest_stack(CardStack *solution_stack, CardStack *working_stack, GameState *state) {
     const CardStackFunctions *sfuncs = get_stack_functions();
     for (int i = WORKING_0; i <= WORKING_6; i++) {
-        if (!sfuncs->is_empty(working_stack[i-WORKING_0])) {
+        if (!sfuncs->is_empty(&working_stack[i-WORKING_0])) {
             state->spot = i;
-            state->index = sfuncs->highest_visible_index(working_stack[i-WORKING_0]);
+            state->index = sfuncs->highest_visible_index(&working_stack[i-WORKING_0]);
             state->saved_spot = NO_SPOT;
             state->saved_index = 0;
             return;
         }
     }
 }
+
+// by-value versions of the stack functions above, for older callers
+Card top_by_value(CardStack stack) {
+    return top(&stack);
+}
+bool is_empty_by_value(CardStack stack) {
+    return is_empty(&stack);
+}
+unsigned int highest_visible_index_by_value(CardStack stack) {
+    return highest_visible_index(&stack);
+}
+unsigned int lowest_visible_index_by_value(CardStack stack) {
+    return lowest_visible_index(&stack);
+}
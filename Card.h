@@ -4,16 +4,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include "GameState.h"
 
-// quick color definitions, for ease of use.
-// colors declared inside main
-#define RED    1
-#define GREEN  2
-#define YELLOW 3
-#define BLUE   4
-#define RESET  5
-
 // Maximum number of cards in a stack. That's 13 visible stacked, plus 6 hidden
 #define MAX_CARDS_IN_STACK 19
 
@@ -30,12 +23,49 @@ typedef struct {
     bool is_visible;
 } Card;
 
-// represents a stack of cards
+// represents a stack of cards. "hash" is the zobrist hash of its cards (see
+// Zobrist.h), kept up to date by the stack functions below; code that writes
+// to "cards" directly has to rehash the stack.
 typedef struct {
     Card cards[MAX_CARDS_IN_STACK];
     unsigned int num_cards;
+    uint64_t hash;
 } CardStack;
 
+// the rules for cards and stacks, inline so the hot paths are not calls
+// through the handlers below, which wrap them
+
+// returns whether or not new_card can go on bottom_card on a solution stack
+static inline bool card_fits_solution(Card bottom_card, Card new_card) {
+    return new_card.value == bottom_card.value+1 && new_card.suit == bottom_card.suit;
+}
+// returns whether or not new_card can go on bottom_card on a working stack:
+// one value lower, and of the other color. Red suits are odd, black suits even.
+static inline bool card_fits_regular(Card bottom_card, Card new_card) {
+    return new_card.value+1 == bottom_card.value && ((new_card.suit ^ bottom_card.suit) & 1);
+}
+// returns the card at the top of a stack, which must not be empty
+static inline Card stack_top(const CardStack *stack) {
+    return stack->cards[stack->num_cards-1];
+}
+// returns whether or not a stack is empty
+static inline bool stack_is_empty(const CardStack *stack) {
+    return stack->num_cards == 0;
+}
+// returns the highest index of all visible cards in the stack
+static inline unsigned int stack_highest_visible_index(const CardStack *stack) {
+    return stack->num_cards-1;
+}
+// returns the lowest index of all visible cards in the stack, or 0 if it is empty
+static inline unsigned int stack_lowest_visible_index(const CardStack *stack) {
+    for (unsigned int i = 0; i < stack->num_cards; i++) {
+        if (stack->cards[i].is_visible) {
+            return i;
+        }
+    }
+    return stack->num_cards ? stack->num_cards-1 : 0;
+}
+
 // holds references to all functions operating on cards or about cards
 typedef struct {
     void (*print)(Card);
@@ -43,9 +73,6 @@ typedef struct {
     const char *(*value_string)(VALUE);
     int (*is_stackable_regular)(Card old_card, Card new_card);
     int (*is_stackable_solution)(Card old_card, Card new_card);
-    void (*draw)(Card, int y, int x, bool, int color);
-    void (*draw_blank)(int y, int x);
-    void (*draw_empty)(int y, int x, bool);
     bool (*equal)(Card, Card);
 } CardFunctions;
 
@@ -54,13 +81,17 @@ typedef struct {
     void (*add_to_stack)(CardStack *, Card);
     Card (*remove_from_stack)(CardStack *);
     void (*move_to_stack)(CardStack *to, CardStack *from, unsigned int index);
-    Card (*top)(CardStack);
-    void (*draw)(CardStack, int y, int x, bool, bool, GameState);
-    void (*display)(CardStack, int y, int x);
-    bool (*is_empty)(CardStack);
-    unsigned int (*highest_visible_index)(CardStack);
-    unsigned int (*lowest_visible_index)(CardStack);
+    void (*set_visible)(CardStack *, unsigned int index, bool is_visible);
+    Card (*top)(const CardStack *);
+    bool (*is_empty)(const CardStack *);
+    unsigned int (*highest_visible_index)(const CardStack *);
+    unsigned int (*lowest_visible_index)(const CardStack *);
     void (*go_to_lowest_stack)(CardStack *, CardStack *, GameState *);
+    // the same, taking a copy of the stack, for callers written before the above took pointers
+    Card (*top_by_value)(CardStack);
+    bool (*is_empty_by_value)(CardStack);
+    unsigned int (*highest_visible_index_by_value)(CardStack);
+    unsigned int (*lowest_visible_index_by_value)(CardStack);
 } CardStackFunctions;
 
 // returns pointer to card function or stack function handler
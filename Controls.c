@@ -0,0 +1,500 @@
+#include "Controls.h"
+#include "Board.h"
+#include "Card.h"
+#include "GameState.h"
+#include "Journal.h"
+#include "Packed.h"
+#include <stdbool.h>
+
+void handle_keypress(char c, Board *board, Journal *journal, GameState *state);
+void handle_selection(Board *board, Journal *journal, GameState *state);
+void handle_history(Board *board, GameState *state);
+void handle_up(Board *board, GameState *state);
+void handle_down(Board *board, GameState *state);
+void handle_left(Board *board, GameState *state);
+void handle_right(Board *board, GameState *state);
+bool game_complete(Board *board, GameState *state);
+bool auto_complete(Board *board, Journal *journal, GameState *state);
+bool auto_play(Board *board, Journal *journal, GameState *state);
+void mark_spot(GameState *state, SELECTED_SPOT spot);
+void mark_entry(GameState *state, JournalEntry entry);
+
+const ControlFunctions control_functions = {
+    .keypress=handle_keypress,
+    .selection=handle_selection,
+    .up=handle_up,
+    .down=handle_down,
+    .left=handle_left,
+    .right=handle_right,
+    .game_complete=game_complete,
+    .auto_complete=auto_complete,
+    .auto_play=auto_play
+};
+
+// returns pointer to the handler for control functions
+const ControlFunctions *get_control_functions() {
+    return &control_functions;
+}
+
+// key press handler
+void handle_keypress(char c, Board *board, Journal *journal, GameState *state) {
+    const JournalFunctions *jfuncs = get_journal_functions();
+    if (state->help_menu_up) {
+        if (c == 'x') {
+            state->help_menu_up = false;
+            state->dirty |= DIRTY_SCREEN;
+        } else {
+            return;
+        }
+    }
+    GameState old_state = *state;
+    switch (c) {
+        case 'h':
+            state->help_menu_up = true;
+            state->dirty |= DIRTY_SCREEN;
+            break;
+        case 'w':
+            handle_up(board, state);
+            break;
+        case 'a':
+            handle_left(board, state);
+            break;
+        case 'd':
+            handle_right(board, state);
+            break;
+        case 's':
+            handle_down(board, state);
+            break;
+        case 'f':
+            if (jfuncs->apply_move(journal, board, (Move){ .type=MOVE_FLIP })) {
+                mark_spot(state, DECK_STACK);
+            }
+            state->saved_spot = NO_SPOT;
+            state->saved_index = 0;
+            break;
+        case 'u':
+            if (jfuncs->undo(journal, board)) {
+                mark_entry(state, journal->entries[journal->position]);
+                handle_history(board, state);
+            }
+            break;
+        case 'r':
+            if (jfuncs->redo(journal, board)) {
+                mark_entry(state, journal->entries[journal->position-1]);
+                handle_history(board, state);
+            }
+            break;
+        case 'l':
+            state->latency_hud_up = !state->latency_hud_up;
+            state->dirty |= DIRTY_SCREEN;
+            break;
+        case 't':
+            // the hint itself is filled in by whoever runs the hint engine
+            state->hint_up = !state->hint_up;
+            mark_spot(state, state->hint_from);
+            mark_spot(state, state->hint_to);
+            break;
+        case 'c':
+            state->saved_spot = NO_SPOT;
+            state->saved_index = 0;
+            break;
+        case ' ':
+            handle_selection(board, journal, state);
+            break;
+        case 'q':
+            break;
+        default:
+            break;
+    }
+
+    // the cursor and selection are drawn on their stacks, so those change with them
+    if (state->spot != old_state.spot || state->index != old_state.index) {
+        mark_spot(state, old_state.spot);
+        mark_spot(state, state->spot);
+    }
+    if (state->saved_spot != old_state.saved_spot || state->saved_index != old_state.saved_index) {
+        mark_spot(state, old_state.saved_spot);
+        mark_spot(state, state->saved_spot);
+    }
+}
+// marks a spot to be drawn again in the next frame
+void mark_spot(GameState *state, SELECTED_SPOT spot) {
+    if (spot != NO_SPOT) {
+        state->dirty |= SPOT_BIT(spot);
+    }
+}
+// marks the spots a journal entry changed to be drawn again in the next frame
+void mark_entry(GameState *state, JournalEntry entry) {
+    mark_spot(state, entry.from);
+    mark_spot(state, entry.to);
+}
+// handles a player pressing space to make a selection
+void handle_selection(Board *board, Journal *journal, GameState *state) {
+    const JournalFunctions   *jfuncs = get_journal_functions();
+    if (state->saved_spot == NO_SPOT) {
+        state->saved_spot  = state->spot;
+        state->saved_index = state->index;
+        return;
+    }
+
+    bool to_solution   = state->spot >= SOLUTION_0 && state->spot <= SOLUTION_3;
+    bool to_working    = state->spot >= WORKING_0 && state->spot <= WORKING_6;
+    bool from_solution = state->saved_spot >= SOLUTION_0 && state->saved_spot <= SOLUTION_3;
+    bool from_working  = state->saved_spot >= WORKING_0 && state->saved_spot <= WORKING_6;
+    if (!to_solution && !to_working) {
+        // nothing can be moved onto the deck, select it instead
+        state->saved_spot = state->spot;
+        state->saved_index = state->index;
+        return;
+    }
+
+    CardStack *to_stack = to_solution
+        ? &board->solution_stacks[state->spot-SOLUTION_0]
+        : &board->working_stacks[state->spot-WORKING_0];
+    bool target_empty = stack_is_empty(to_stack);
+    Move move = {
+        .type=MOVE_CARDS,
+        .from=state->saved_spot,
+        .to=state->spot,
+        .index=state->saved_index
+    };
+
+    if (jfuncs->apply_move(journal, board, move)) {
+        mark_spot(state, move.from);
+        mark_spot(state, move.to);
+        if (!target_empty) {
+            state->index++;
+        }
+        state->saved_spot = NO_SPOT;
+        state->saved_index = 0;
+    } else if (target_empty && !(to_solution && from_solution)) {
+        // card can't start the empty stack, go back to where the selection was made
+        state->spot = state->saved_spot;
+        state->index = state->saved_index;
+        state->saved_spot = NO_SPOT;
+        state->saved_index = 0;
+    } else if (to_solution && from_working) {
+        // not compatible, go back to the selection and keep it
+        state->spot = state->saved_spot;
+        state->index = state->saved_index;
+    } else {
+        // not compatible, select the new stack instead
+        state->saved_spot = state->spot;
+        state->saved_index = state->index;
+    }
+}
+// keeps the cursor on the board after a move is taken back or played again:
+// the selection is dropped, and the cursor is moved onto the face up cards of
+// its stack
+void handle_history(Board *board, GameState *state) {
+    state->saved_spot = NO_SPOT;
+    state->saved_index = 0;
+    if (state->spot >= WORKING_0 && state->spot <= WORKING_6) {
+        const CardStack *stack = &board->working_stacks[state->spot-WORKING_0];
+        if (stack_is_empty(stack)) {
+            state->index = 0;
+        } else if (state->index < stack_lowest_visible_index(stack)) {
+            state->index = stack_lowest_visible_index(stack);
+        } else if (state->index > stack_highest_visible_index(stack)) {
+            state->index = stack_highest_visible_index(stack);
+        }
+    }
+}
+// handles the player pressing w to move up
+void handle_up(Board *board, GameState *state) {
+    switch (state->spot) {
+        // cannot move up from these
+        case DECK_STACK:
+        case SOLUTION_0:
+        case SOLUTION_1:
+        case SOLUTION_2:
+        case SOLUTION_3:
+            break;
+        case WORKING_0:
+        case WORKING_1:
+        case WORKING_2:
+        case WORKING_3:
+        case WORKING_4:
+        {
+            // tries to move upward to the solution stack above it
+            unsigned int stack_index = state->spot - WORKING_0;
+            Card card = board->working_stacks[stack_index].cards[state->index];
+            if (state->index == stack_lowest_visible_index(&board->working_stacks[stack_index])) {
+                // adjust for WORKING_4 being to the side of SOLUTION_3
+                if (stack_index == SOLUTION_3+1) { stack_index--; }
+                if (board->solution_stacks[SOLUTION_0+stack_index].num_cards != 0 || state->saved_spot != NO_SPOT) {
+                    state->spot = SOLUTION_0+stack_index;
+                } else {
+                    for (int i = SOLUTION_0; i <= SOLUTION_3; i++) {
+                        if (board->solution_stacks[i].num_cards != 0) {
+                            state->spot = i;
+                            state->index = 0;
+                            break;
+                        }
+                    }
+                }
+            } else if (card.is_visible) {
+                Card prev_card = board->working_stacks[stack_index].cards[state->index-1];
+                if (prev_card.is_visible) {
+                    state->index--;
+                } else {
+                    state->spot = SOLUTION_0+stack_index;
+                    // adjust for WORKING_4 being to the side of SOLUTION_3
+                    if (stack_index == 4) { state->spot--; };
+                }
+            }
+            break;
+        }
+        case WORKING_5:
+        case WORKING_6:
+        {
+            unsigned int stack_index = state->spot - WORKING_0;
+            Card card = board->working_stacks[stack_index].cards[state->index];
+            if (state->index == 0) {
+                if (board->deck.num_cards_discard != 0) {
+                    state->spot = DECK_STACK;
+                }
+            } else if (card.is_visible) {
+                Card prev_card = board->working_stacks[stack_index].cards[state->index-1];
+                if (prev_card.is_visible) {
+                    state->index--;
+                } else {
+                    if (board->deck.num_cards_discard != 0) {
+                        state->spot = DECK_STACK;
+                    }
+                }
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+// handles the player pressing s to move down
+void handle_down(Board *board, GameState *state) {
+    const CardStackFunctions *sfuncs = get_stack_functions();
+    switch (state->spot) {
+        // tries to move below
+        case DECK_STACK:
+        {
+            // moves to one of the two right-most working stacks to the lowest (visually highest)
+            // visible index
+            if (!stack_is_empty(&board->working_stacks[5])) {
+                state->spot  = WORKING_5;
+                state->index = stack_lowest_visible_index(&board->working_stacks[5]);
+            } else if (!stack_is_empty(&board->working_stacks[6])) {
+                state->spot  = WORKING_6;
+                state->index = stack_lowest_visible_index(&board->working_stacks[6]);
+            } else if (state->saved_spot != NO_SPOT) {
+                // if neither 5 nor 6 have cards and
+                // if a selection has been made, then moves to 5 even if its empty
+                state->spot  = WORKING_5;
+                state->index = stack_lowest_visible_index(&board->working_stacks[5]);
+            }
+            break;
+        }
+        case SOLUTION_0:
+        case SOLUTION_1:
+        case SOLUTION_2:
+        case SOLUTION_3:
+        {
+            // tries moving to working stack immediately below to visually highest/numerically
+            // lowest index
+            if (!stack_is_empty(&board->working_stacks[state->spot]) || state->saved_spot != NO_SPOT) {
+                state->spot = state->spot + WORKING_0;
+                state->index = stack_lowest_visible_index(&board->working_stacks[state->spot-WORKING_0]);
+            } else {
+                // if that fails, goes to the ordinally lowest stack
+                sfuncs->go_to_lowest_stack(board->solution_stacks, board->working_stacks, state);
+                state->index = stack_lowest_visible_index(&board->working_stacks[state->spot-WORKING_0]);
+            }
+            break;
+        }
+        case WORKING_0:
+        case WORKING_1:
+        case WORKING_2:
+        case WORKING_3:
+        case WORKING_4:
+        case WORKING_5:
+        case WORKING_6:
+        {
+            // tries to move downward on the stack its on
+            unsigned int which_stack = state->spot - WORKING_0;
+            if (state->index < stack_highest_visible_index(&board->working_stacks[which_stack])) {
+                state->index++;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+// handles the player pressing a to move left
+void handle_left(Board *board, GameState *state) {
+    switch (state->spot) {
+        // moves 1 left if possible, otherwise trying more
+        case DECK_STACK:
+            if (!stack_is_empty(&board->solution_stacks[SOLUTION_3]) || state->saved_spot != NO_SPOT) {
+                state->spot = SOLUTION_3;
+                break;
+            }
+        // moves 1 left if possible, otherwise trying more
+        case SOLUTION_3:
+            if (!stack_is_empty(&board->solution_stacks[SOLUTION_2]) || state->saved_spot != NO_SPOT) {
+                state->spot = SOLUTION_2;
+                break;
+            }
+        // moves 1 left if possible, otherwise trying more
+        case SOLUTION_2:
+            if (!stack_is_empty(&board->solution_stacks[SOLUTION_1]) || state->saved_spot != NO_SPOT) {
+                state->spot = SOLUTION_1;
+                break;
+            }
+        // moves 1 left if possible, otherwise trying more
+        case SOLUTION_1:
+            if (!stack_is_empty(&board->solution_stacks[SOLUTION_0]) || state->saved_spot != NO_SPOT) {
+                state->spot = SOLUTION_0;
+                break;
+            }
+        // moves 1 left if possible, otherwise not moving
+        case SOLUTION_0:
+            break;
+        case WORKING_6:
+        case WORKING_5:
+        case WORKING_4:
+        case WORKING_3:
+        case WORKING_2:
+        case WORKING_1:
+        case WORKING_0:
+        {
+            do {
+                // move left until a stack with 1 or more is found, unless a selection has been made, in
+                // which case it will also move onto empty spots
+                state->spot = state->spot == WORKING_0 ? WORKING_6 : state->spot-1;
+            } while (state->saved_spot == NO_SPOT && stack_is_empty(&board->working_stacks[state->spot-WORKING_0]));
+            // gets the index of the stack landed upon
+            int stack_idx = state->spot-WORKING_0;
+            // gets the highest and lowest visible indexes in the stack
+            int highest_idx = stack_highest_visible_index(&board->working_stacks[stack_idx]);
+            int lowest_idx = stack_lowest_visible_index(&board->working_stacks[stack_idx]);
+            // if index is outside range of low-high, goes to the closest end
+            if (state->index < lowest_idx) {
+                state->index = lowest_idx;
+            } else if (state->index > highest_idx) {
+                state->index = highest_idx;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+// handles the player pressing d to move right
+void handle_right(Board *board, GameState *state) {
+    switch (state->spot) {
+        // moves 1 right if possible, otherwise trying more
+        case SOLUTION_0:
+            if (!stack_is_empty(&board->solution_stacks[SOLUTION_1]) || state->saved_spot != NO_SPOT) {
+                state->spot = SOLUTION_1;
+                break;
+            }
+        // moves 1 right if possible, otherwise trying more
+        case SOLUTION_1:
+            if (!stack_is_empty(&board->solution_stacks[SOLUTION_2]) || state->saved_spot != NO_SPOT) {
+                state->spot = SOLUTION_2;
+                break;
+            }
+        // moves 1 right if possible, otherwise trying more
+        case SOLUTION_2:
+            if (!stack_is_empty(&board->solution_stacks[SOLUTION_3]) || state->saved_spot != NO_SPOT) {
+                state->spot = SOLUTION_3;
+                break;
+            }
+        // moves 1 right if possible, otherwise not moving
+        case SOLUTION_3:
+            if (board->deck.num_cards_discard != 0) {
+                state->spot = DECK_STACK;
+                break;
+            }
+        case DECK_STACK:
+            break;
+        case WORKING_6:
+        case WORKING_5:
+        case WORKING_4:
+        case WORKING_3:
+        case WORKING_2:
+        case WORKING_1:
+        case WORKING_0:
+        {
+            do {
+                // move right until a stack with 1 or more is found, unless a selection has been made, in
+                // which case it will also move onto empty spots
+                state->spot = state->spot == WORKING_6 ? WORKING_0 : state->spot+1;
+            } while (state->saved_spot == NO_SPOT && stack_is_empty(&board->working_stacks[state->spot-WORKING_0]));
+            // gets the index of the stack landed upon
+            int stack_idx = state->spot-WORKING_0;
+            // gets the highest and lowest visible indexes in the stack
+            int highest_idx = stack_highest_visible_index(&board->working_stacks[stack_idx]);
+            int lowest_idx = stack_lowest_visible_index(&board->working_stacks[stack_idx]);
+            // if index is outside range of low-high, goes to the closest end
+            if (state->index < lowest_idx) {
+                state->index = lowest_idx;
+            } else if (state->index > highest_idx) {
+                state->index = highest_idx;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+// returns whether or not the game is complete
+bool game_complete(Board *board, GameState *state) {
+    return get_board_functions()->is_won(board);
+}
+// plays a move the player did not pick, dropping any selection. Returns
+// whether or not the move was played.
+static bool play_for_player(Board *board, Journal *journal, GameState *state, Move move) {
+    if (!get_journal_functions()->apply_move(journal, board, move)) {
+        return false;
+    }
+    mark_spot(state, move.from);
+    mark_spot(state, move.to);
+    // the hint was for the position before the sweep
+    if (state->hint_up) {
+        state->hint_up = false;
+        mark_spot(state, state->hint_from);
+        mark_spot(state, state->hint_to);
+    }
+    mark_spot(state, state->saved_spot);
+    state->saved_spot = NO_SPOT;
+    state->saved_index = 0;
+    // keeps the cursor on a card of the stack it is on
+    if (state->spot == move.from) {
+        if (move.from >= WORKING_0 && move.from <= WORKING_6) {
+            const CardStack *from = &board->working_stacks[move.from-WORKING_0];
+            if (state->index > 0 && state->index >= from->num_cards) {
+                state->index = from->num_cards ? from->num_cards-1 : 0;
+            }
+        } else if (move.from == DECK_STACK) {
+            state->index = 0;
+        }
+    }
+    return true;
+}
+// plays the next card of the sweep that finishes the game once every card
+// is face up and the deck is used up. Returns false when there is nothing
+// left to sweep.
+bool auto_complete(Board *board, Journal *journal, GameState *state) {
+    Move move;
+    return get_board_functions()->auto_complete_move(board, &move)
+        && play_for_player(board, journal, state, move);
+}
+// sends one card to a solution stack when that can never hurt. Returns false
+// when there is no such card.
+bool auto_play(Board *board, Journal *journal, GameState *state) {
+    PackedBoard packed = get_packed_functions()->pack(board);
+    Move move;
+    return get_packed_functions()->safe_solution_move(&packed, &move)
+        && play_for_player(board, journal, state, move);
+}
@@ -0,0 +1,25 @@
+#ifndef __CONTROLS_H__
+#define __CONTROLS_H__
+#include <stdbool.h>
+#include "Board.h"
+#include "GameState.h"
+#include "Journal.h"
+
+// handler struct for what the player's keys do to the game: moving the cursor,
+// selecting and moving cards, and taking moves back. Draws nothing; the spots
+// that need drawing again are marked in the game state.
+typedef struct {
+    void (*keypress)(char c, Board *, Journal *, GameState *);
+    void (*selection)(Board *, Journal *, GameState *);
+    void (*up)(Board *, GameState *);
+    void (*down)(Board *, GameState *);
+    void (*left)(Board *, GameState *);
+    void (*right)(Board *, GameState *);
+    bool (*game_complete)(Board *, GameState *);
+    bool (*auto_complete)(Board *, Journal *, GameState *);
+    bool (*auto_play)(Board *, Journal *, GameState *);
+} ControlFunctions;
+
+const ControlFunctions *get_control_functions();
+
+#endif /* __CONTROLS_H__ */
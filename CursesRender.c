@@ -0,0 +1,61 @@
+// cchar_t and the functions that draw it are part of the wide character curses API
+#define _XOPEN_SOURCE_EXTENDED
+#include "Render.h"
+#include <ncursesw/ncurses.h>
+#include <wchar.h>
+
+void curses_erase(void);
+void curses_text(int y, int x, const char *text);
+void curses_load_glyph(unsigned int id, const Glyph *);
+void curses_glyph(unsigned int id, int y, int x);
+int curses_lines(void);
+int curses_cols(void);
+
+const RenderBackend curses_backend = {
+    .erase=curses_erase,
+    .text=curses_text,
+    .load_glyph=curses_load_glyph,
+    .glyph=curses_glyph,
+    .lines=curses_lines,
+    .cols=curses_cols
+};
+
+// glyphs as rows of curses cells, each ending in an empty cell, ready for mvadd_wchstr
+static cchar_t glyphs[MAX_GLYPHS][CARD_HEIGHT][CARD_WIDTH+1];
+
+// returns pointer to the backend that draws with ncurses
+const RenderBackend *get_curses_backend() {
+    return &curses_backend;
+}
+
+// overwrites all characters on screen with blanks
+void curses_erase(void) {
+    erase();
+}
+// writes text in the default color
+void curses_text(int y, int x, const char *text) {
+    mvaddstr(y, x, text);
+}
+// converts a glyph into curses cells
+void curses_load_glyph(unsigned int id, const Glyph *glyph) {
+    for (int row = 0; row < CARD_HEIGHT; row++) {
+        for (int col = 0; col < CARD_WIDTH; col++) {
+            setcchar(&glyphs[id][row][col], (wchar_t[]){ glyph->cells[row][col].ch, L'\0' }, A_NORMAL, glyph->cells[row][col].color, NULL);
+        }
+        setcchar(&glyphs[id][row][CARD_WIDTH], L"", A_NORMAL, 0, NULL);
+    }
+}
+// copies a glyph onto the screen
+void curses_glyph(unsigned int id, int y, int x) {
+    for (int row = 0; row < CARD_HEIGHT; row++) {
+        mvadd_wchstr(y+row, x, glyphs[id][row]);
+    }
+}
+// returns the height of the terminal
+int curses_lines(void) {
+    return LINES;
+}
+// returns the width of the terminal
+int curses_cols(void) {
+    return COLS;
+}
@@ -1,45 +1,50 @@
 #include "Deck.h"
 #include "Card.h"
+#include "Random.h"
+#include "Zobrist.h"
 #include <stdbool.h>
 #include <stdlib.h>
-#include <time.h>
 
-void print_deck(Deck);
+void print_deck(const Deck *);
 Deck get_fresh_deck(void);
-void display_deck(Deck deck, int y, int x);
-void shuffle(Deck *);
+void shuffle(Deck *, Rng *);
+bool can_flip(const Deck *);
 void flip(Deck *);
-void draw_deck(Deck deck, int y, int x, GameState);
 Card remove_card(Deck *);
 Card remove_from_discard(Deck *);
+void add_to_discard(Deck *, Card);
+void unflip(Deck *, unsigned int num_cards, bool recycled);
+void print_deck_by_value(Deck);
 
 DeckFunctions deck_functions = {
     .print=print_deck,
     .fresh_deck=get_fresh_deck,
-    .display=display_deck,
     .shuffle=shuffle,
+    .can_flip=can_flip,
     .flip=flip,
-    .draw=draw_deck,
     .remove_card=remove_card,
-    .remove_from_stack=remove_from_discard
+    .remove_from_stack=remove_from_discard,
+    .add_to_discard=add_to_discard,
+    .unflip=unflip,
+    .print_by_value=print_deck_by_value
 };
 
 // prints the contents of a deck in text format
-void print_deck(Deck deck) {
+void print_deck(const Deck *deck) {
     const CardFunctions *cfuncs = get_card_functions();
-    printf("Num cards: %d\n", deck.num_cards);
-    for (unsigned int i = 0; i < deck.num_cards; i++) {
+    printf("Num cards: %d\n", deck->num_cards);
+    for (unsigned int i = 0; i < deck->num_cards; i++) {
         if (i > 0 && i % NUM_VALUES == 0) {
             printf("\n");
         }
-        cfuncs->print(deck.cards[i]);
+        cfuncs->print(deck->cards[i]);
     }
     printf("\n");
 }
 
 // gives an ordered deck of 52 cards
 Deck get_fresh_deck(void) {
-    Deck deck = { .num_cards=0, .num_cards_discard=0 };
+    Deck deck = { .num_cards=0, .num_cards_discard=0, .passes=0 };
     for (SUIT suit = SPADE; suit < NUM_SUITS; suit++) {
         for (VALUE value = VALUE_ACE; value < NUM_VALUES; value++) {
             deck.cards[deck.num_cards++] = (Card){
@@ -47,6 +52,7 @@ Deck get_fresh_deck(void) {
             };
         }
     }
+    deck.hash = get_zobrist_functions()->deck_hash(&deck);
     return deck;
 }
 
@@ -55,85 +61,94 @@ const DeckFunctions *get_deck_functions() {
     return &deck_functions;
 }
 
-// displays deck and discard stack and its contents
-void display_deck(Deck deck, int y, int x) {
-    const CardFunctions *cfuncs = get_card_functions();
-    unsigned int row = 0, col = 0;
-    for (unsigned int i = 0; i < deck.num_cards; i++) {
-        cfuncs->draw(deck.cards[i], y + row * 4, x + col * 6, false, RESET);
-        col++;
-        if (col == 13) {
-            col = 0;
-            row++;
-        }
-
-    }
-    col = 0;
-    row += 2;
-    for (unsigned int i = 0; i < deck.num_cards_discard; i++) {
-        cfuncs->draw(deck.discard[i], y + row * 4, x + col * 6, false, RESET);
-        col++;
-        if (col == 13) {
-            col = 0;
-            row++;
-        }
+// shuffles the cards that are in the deck in place (Fisher-Yates), drawing
+// from the given generator
+void shuffle(Deck *deck, Rng *rng) {
+    const RandomFunctions *rfuncs = get_random_functions();
+    for (unsigned int i = deck->num_cards; i > 1; i--) {
+        unsigned int j = rfuncs->below(rng, i);
+        Card temp = deck->cards[i-1];
+        deck->cards[i-1] = deck->cards[j];
+        deck->cards[j] = temp;
     }
+    deck->hash = get_zobrist_functions()->deck_hash(deck);
 }
 
-// shuffles the cards that are in the deck
-void shuffle(Deck *deck) {
-    Card temp_buf[52];
-    srand(time(NULL));
-
-    for (int cards_left = deck->num_cards; cards_left > 0; cards_left--) {
-        int card_to_remove = rand() % cards_left;
-        temp_buf[cards_left-1] = deck->cards[card_to_remove];
-        for (int i = card_to_remove; i < cards_left; i++) {
-            deck->cards[i] = deck->cards[i+1];
-        }
-    }
-
-    for (int i = 0; i < deck->num_cards; i++) {
-        deck->cards[i] = temp_buf[i];
-    }
+// returns whether or not there is a card to flip, counting the discard pile
+// while there are passes left to turn it back into the deck
+bool can_flip(const Deck *deck) {
+    return deck->num_cards || (deck->num_cards_discard && CAN_RECYCLE(deck->passes));
 }
-
-// flips a card from the deck to the discard pile, recycling the discard into
-// the deck if necessary
+// moves the top card of the discard pile onto the deck
+static void discard_to_deck(Deck *deck) {
+    Card card = deck->discard[--deck->num_cards_discard];
+    deck->hash ^= zobrist_card_key(PACKED_DISCARD, deck->num_cards_discard, card)
+                ^ zobrist_card_key(PACKED_DECK, deck->num_cards, card);
+    deck->cards[deck->num_cards++] = card;
+}
+// moves the top card of the deck onto the discard pile
+static void deck_to_discard(Deck *deck) {
+    Card card = deck->cards[--deck->num_cards];
+    deck->hash ^= zobrist_card_key(PACKED_DECK, deck->num_cards, card)
+                ^ zobrist_card_key(PACKED_DISCARD, deck->num_cards_discard, card);
+    deck->discard[deck->num_cards_discard++] = card;
+}
+// sets the number of passes through the deck
+static void set_passes(Deck *deck, unsigned int passes) {
+#if PASS_LIMIT
+    deck->hash ^= zobrist_mix(ZOBRIST_PASSES, 0, deck->passes) ^ zobrist_mix(ZOBRIST_PASSES, 0, passes);
+#endif
+    deck->passes = passes;
+}
+// flips DRAW_COUNT cards, or as many as are left, from the deck to the discard
+// pile, recycling the discard into the deck if necessary
 void flip(Deck * deck) {
+    if (!can_flip(deck)) {
+        return;
+    }
     if (deck->num_cards == 0) {
         while (deck->num_cards_discard) {
-            deck->cards[deck->num_cards++] = deck->discard[--deck->num_cards_discard];
+            discard_to_deck(deck);
         }
+        set_passes(deck, deck->passes+1);
+    }
+    for (unsigned int i = 0; i < DRAW_COUNT && deck->num_cards; i++) {
+        deck_to_discard(deck);
     }
-    deck->discard[deck->num_cards_discard++] = deck->cards[--deck->num_cards];
 }
-
-// draws the deck for the game
-void draw_deck(Deck deck, int y, int x, GameState state) {
-    const CardFunctions *cfuncs = get_card_functions();
-    if (deck.num_cards_discard) {
-        int color = RESET;
-        if (state.spot == DECK_STACK) {
-            color = GREEN;
-        } else if (state.saved_spot == DECK_STACK) {
-            color = YELLOW;
-        }
-        cfuncs->draw(deck.discard[deck.num_cards_discard-1], y, x, state.spot == DECK_STACK || state.saved_spot == DECK_STACK, color);
-    } else {
-        cfuncs->draw_empty(y, x, false);
+// takes back a flip that turned over "num_cards" cards. If it recycled the
+// discard pile first, that is taken back too.
+void unflip(Deck *deck, unsigned int num_cards, bool recycled) {
+    for (unsigned int i = 0; i < num_cards; i++) {
+        discard_to_deck(deck);
     }
-    if (deck.num_cards) {
-        cfuncs->draw_blank(y, x+7);
-    } else {
-        cfuncs->draw_empty(y, x+7, false);
+    // recycling reversed the discard pile into the deck, so reverse it back
+    if (recycled) {
+        while (deck->num_cards) {
+            deck_to_discard(deck);
+        }
+        set_passes(deck, deck->passes-1);
     }
 }
+
 // removes a card from the top of the deck, returning it
 Card remove_card(Deck *deck) {
-    return deck->cards[--deck->num_cards];
+    Card card = deck->cards[--deck->num_cards];
+    deck->hash ^= zobrist_card_key(PACKED_DECK, deck->num_cards, card);
+    return card;
 }
 // removes a card from the top of the discard pile, returning it
 Card remove_from_discard(Deck *deck) {
-    return deck->discard[--deck->num_cards_discard];
+    Card card = deck->discard[--deck->num_cards_discard];
+    deck->hash ^= zobrist_card_key(PACKED_DISCARD, deck->num_cards_discard, card);
+    return card;
+}
+// puts a card back on top of the discard pile
+void add_to_discard(Deck *deck, Card card) {
+    deck->hash ^= zobrist_card_key(PACKED_DISCARD, deck->num_cards_discard, card);
+    deck->discard[deck->num_cards_discard++] = card;
+}
+// prints a copy of a deck, for older callers
+void print_deck_by_value(Deck deck) {
+    print_deck(&deck);
 }
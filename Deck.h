@@ -1,26 +1,36 @@
 #ifndef __DECK_H__
 #define __DECK_H__
+#include <stdint.h>
 #include "Card.h"
 #include "GameState.h"
+#include "Random.h"
+#include "Rules.h"
 
-// struct to hold up to 52 cards
+// struct to hold up to 52 cards. "passes" counts how many times the discard
+// pile has been turned back into the deck. "hash" is the zobrist hash of both
+// piles and the passes (see Zobrist.h), kept up to date by the deck functions.
 typedef struct {
     Card cards[52];
     unsigned int num_cards;
     Card discard[52];
     unsigned int num_cards_discard;
+    unsigned int passes;
+    uint64_t hash;
 } Deck;
 
 // handler struct for all functions related to decks
 typedef struct {
-    void (*print)(Deck);
+    void (*print)(const Deck *);
     Deck (*fresh_deck)(void);
-    void (*display)(Deck, int y, int x);
-    void (*shuffle)(Deck *);
+    void (*shuffle)(Deck *, Rng *);
+    bool (*can_flip)(const Deck *);
     void (*flip)(Deck *);
-    void (*draw)(Deck, int y, int x, GameState);
     Card (*remove_card)(Deck *);
     Card (*remove_from_stack)(Deck *);
+    void (*add_to_discard)(Deck *, Card);
+    void (*unflip)(Deck *, unsigned int num_cards, bool recycled);
+    // the same as print, taking a copy of the deck, for callers written before it took a pointer
+    void (*print_by_value)(Deck);
 } DeckFunctions;
 
 const DeckFunctions *get_deck_functions();
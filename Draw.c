@@ -0,0 +1,399 @@
+#include "Draw.h"
+#include "Board.h"
+#include "Card.h"
+#include "Deck.h"
+#include "GameState.h"
+#include "Render.h"
+#include <stdio.h>
+#include <wchar.h>
+
+#define DECK_POS        0, 35
+// how many of the top cards of the discard pile are fanned out leftwards, and how far apart
+#define FAN_CARDS       (DRAW_COUNT < 3 ? DRAW_COUNT : 3)
+#define FAN_STEP        4
+#define SOL_STACK_0_POS 0, 0
+#define SOL_STACK_1_POS 0, 7
+#define SOL_STACK_2_POS 0, 14
+#define SOL_STACK_3_POS 0, 21
+
+#define WORK_STACK0_POS 5, 0
+#define WORK_STACK1_POS 5, 7
+#define WORK_STACK2_POS 5, 14
+#define WORK_STACK3_POS 5, 21
+#define WORK_STACK4_POS 5, 28
+#define WORK_STACK5_POS 5, 35
+#define WORK_STACK6_POS 5, 42
+
+// where the status line goes, just after the help label, and how wide it is
+#define STATUS_POS   4, 49
+#define STATUS_WIDTH 24
+
+// cells covered by the help menu
+#define HELP_MENU_CELLS (28 * 52)
+
+void draw_card(Card, int y, int x, bool, int color);
+void draw_blank_card(int y, int x, bool, int color);
+void draw_empty_card(int y, int x, bool, int color);
+void draw_stack(const CardStack *, int y, int x, bool selected_stack, bool saved_stack, int hint_card, GameState state);
+void display_stack(const CardStack *, int y, int x);
+void draw_deck(const Deck *, int y, int x, GameState);
+void display_deck(const Deck *, int y, int x);
+void set_backend(const RenderBackend *);
+static void set_glyph_row(Cell *row, const wchar_t *text, short color);
+unsigned int stack_rows(const CardStack *);
+void clear_area(int y, int x, int height, int width);
+void draw_screen(Board *board, GameState *state, Screen *screen);
+void draw_help_menu(void);
+
+// initializer for draw function handler
+const DrawFunctions draw_functions = {
+    .card=draw_card,
+    .blank=draw_blank_card,
+    .empty=draw_empty_card,
+    .stack=draw_stack,
+    .display_stack=display_stack,
+    .deck=draw_deck,
+    .display_deck=display_deck,
+    .set_backend=set_backend,
+    .stack_rows=stack_rows,
+    .clear_area=clear_area,
+    .screen=draw_screen,
+    .help_menu=draw_help_menu
+};
+
+// ids of the glyphs handed to the backend: every card face, the card back and
+// the empty spot, each in every highlight color. Color 0 is the terminal's default.
+#define NUM_GLYPH_COLORS        (RESET+1)
+#define CARD_GLYPH(color, card) ((color)*NUM_SUITS*NUM_VALUES + (card).suit*NUM_VALUES + (card).value)
+#define BACK_GLYPH(color)       (NUM_GLYPH_COLORS*NUM_SUITS*NUM_VALUES + (color))
+#define EMPTY_GLYPH(color)      (BACK_GLYPH(NUM_GLYPH_COLORS) + (color))
+#define NUM_GLYPHS              EMPTY_GLYPH(NUM_GLYPH_COLORS)
+_Static_assert(NUM_GLYPHS <= MAX_GLYPHS, "too many glyphs for the render backends");
+
+// where everything is drawn
+static const RenderBackend *backend = NULL;
+
+// returns a pointer to the draw function handler
+const DrawFunctions *get_draw_functions() {
+    return &draw_functions;
+}
+// draws with the given backend from now on, first handing it the glyphs for
+// every card face, the card back and the empty spot
+void set_backend(const RenderBackend *new_backend) {
+    const CardFunctions *cfuncs = get_card_functions();
+    Glyph glyph;
+    backend = new_backend;
+    for (int color = 0; color < NUM_GLYPH_COLORS; color++) {
+        for (SUIT suit = SPADE; suit < NUM_SUITS; suit++) {
+            for (VALUE value = VALUE_ACE; value < NUM_VALUES; value++) {
+                wchar_t middle[CARD_WIDTH+1];
+                swprintf(middle, CARD_WIDTH+1, L"│%2s%lc │", cfuncs->value_string(value), (wint_t)cfuncs->suit_string(suit)[0]);
+                set_glyph_row(glyph.cells[0], L"┌────┐", color);
+                set_glyph_row(glyph.cells[1], middle, color);
+                set_glyph_row(glyph.cells[2], L"│    │", color);
+                set_glyph_row(glyph.cells[3], L"└────┘", color);
+                // the value is never highlighted, and red suits are always red
+                glyph.cells[1][1].color = glyph.cells[1][2].color = 0;
+                glyph.cells[1][3].color = suit == DIAMOND || suit == HEART ? RED : 0;
+                backend->load_glyph(CARD_GLYPH(color, ((Card){ .suit=suit, .value=value })), &glyph);
+            }
+        }
+    }
+    for (int color = 0; color < NUM_GLYPH_COLORS; color++) {
+        // only the border of the back is highlighted, not the suits on it
+        set_glyph_row(glyph.cells[0], L"┌────┐", color);
+        set_glyph_row(glyph.cells[1], L"│♠  ♦│", 0);
+        set_glyph_row(glyph.cells[2], L"│♥  ♣│", 0);
+        set_glyph_row(glyph.cells[3], L"└────┘", color);
+        glyph.cells[1][0].color = glyph.cells[1][5].color = glyph.cells[2][0].color = glyph.cells[2][5].color = color;
+        backend->load_glyph(BACK_GLYPH(color), &glyph);
+
+        set_glyph_row(glyph.cells[0], L"┌────┐", color);
+        set_glyph_row(glyph.cells[1], L"│ ╲╱ │", color);
+        set_glyph_row(glyph.cells[2], L"│ ╱╲ │", color);
+        set_glyph_row(glyph.cells[3], L"└────┘", color);
+        backend->load_glyph(EMPTY_GLYPH(color), &glyph);
+    }
+}
+// fills one row of a glyph from a string of CARD_WIDTH characters in the given color pair
+static void set_glyph_row(Cell *row, const wchar_t *text, short color) {
+    for (int i = 0; i < CARD_WIDTH; i++) {
+        row[i] = (Cell){ text[i], color };
+    }
+}
+// draws a card on the screen. Takes into account whether or not the color needs to be different.
+void draw_card(Card card, int y, int x, bool selected, int color) {
+    if (!card.is_visible) {
+        draw_blank_card(y, x, selected, color);
+        return;
+    }
+    backend->glyph(CARD_GLYPH(selected ? color : 0, card), y, x);
+}
+// draws a blank card
+void draw_blank_card(int y, int x, bool selected, int color) {
+    backend->glyph(BACK_GLYPH(selected ? color : 0), y, x);
+}
+// draws an empty card spot
+void draw_empty_card(int y, int x, bool selected, int color) {
+    backend->glyph(EMPTY_GLYPH(selected ? color : 0), y, x);
+}
+// draws the stack on the screen. "hint_card" is the index of the card the
+// hint points at, or -1 if the stack is not part of the hint.
+void draw_stack(const CardStack *stack, int y, int x, bool selected_stack, bool saved_stack, int hint_card, GameState state) {
+    if (stack->num_cards == 0) {
+        draw_empty_card(y, x, selected_stack || hint_card >= 0, selected_stack ? GREEN : BLUE);
+        return;
+    }
+
+    for (int i = 0, row = 0; i < stack->num_cards; i++) {
+        bool selected = selected_stack && state.index == i;
+        bool saved_selected = saved_stack && state.saved_index == i;
+        bool hinted = hint_card == i;
+        int color = RESET;
+        if (selected) {
+            color = GREEN;
+        } else if (saved_selected) {
+            color = YELLOW;
+        } else if (hinted) {
+            color = BLUE;
+        }
+        draw_card(stack->cards[i], y+row, x, selected || saved_selected || hinted, color);
+        if (stack->cards[i].is_visible) {
+            row += 2;
+        } else {
+            row += 1;
+        }
+    }
+}
+// returns the number of rows draw_stack takes up for the stack
+unsigned int stack_rows(const CardStack *stack) {
+    unsigned int rows = CARD_HEIGHT;
+    for (unsigned int i = 0; i+1 < stack->num_cards; i++) {
+        rows += stack->cards[i].is_visible ? 2 : 1;
+    }
+    return rows;
+}
+// overwrites an area of the screen with blanks
+void clear_area(int y, int x, int height, int width) {
+    char blanks[256];
+    snprintf(blanks, sizeof(blanks), "%*s", width, "");
+    for (int row = 0; row < height; row++) {
+        backend->text(y+row, x, blanks);
+    }
+}
+// displays the contents of the stack at given x y coordinates
+void display_stack(const CardStack *stack, int y, int x) {
+    char label[32];
+    snprintf(label, sizeof(label), "Num cards: %d", stack->num_cards);
+    backend->text(y, x, label);
+    for (int i = 0; i < stack->num_cards; i++) {
+        draw_card(stack->cards[i], y+1, x+i*6, false, RESET);
+    }
+}
+// draws the deck for the game
+void draw_deck(const Deck *deck, int y, int x, GameState state) {
+    // a hinted flip points at the deck, any other hinted move from the deck at the discard pile
+    bool hinted_flip = state.hint_up && state.hint_from == DECK_STACK && state.hint_to == DECK_STACK;
+    bool hinted_discard = state.hint_up && state.hint_from == DECK_STACK && !hinted_flip;
+    // with more than one card turned over per flip, the ones under the top
+    // card are fanned out to its left
+    if (FAN_CARDS > 1) {
+        clear_area(y, x - (FAN_CARDS-1)*FAN_STEP, CARD_HEIGHT, (FAN_CARDS-1)*FAN_STEP);
+        for (unsigned int i = FAN_CARDS-1; i > 0; i--) {
+            if (deck->num_cards_discard > i) {
+                draw_card(deck->discard[deck->num_cards_discard-1-i], y, x - i*FAN_STEP, false, RESET);
+            }
+        }
+    }
+    if (deck->num_cards_discard) {
+        int color = RESET;
+        if (state.spot == DECK_STACK) {
+            color = GREEN;
+        } else if (state.saved_spot == DECK_STACK) {
+            color = YELLOW;
+        } else if (hinted_discard) {
+            color = BLUE;
+        }
+        draw_card(deck->discard[deck->num_cards_discard-1], y, x,
+                  state.spot == DECK_STACK || state.saved_spot == DECK_STACK || hinted_discard, color);
+    } else {
+        draw_empty_card(y, x, false, RESET);
+    }
+    if (deck->num_cards) {
+        draw_blank_card(y, x+7, hinted_flip, BLUE);
+    } else {
+        draw_empty_card(y, x+7, hinted_flip, BLUE);
+    }
+}
+// displays deck and discard stack and its contents
+void display_deck(const Deck *deck, int y, int x) {
+    unsigned int row = 0, col = 0;
+    for (unsigned int i = 0; i < deck->num_cards; i++) {
+        draw_card(deck->cards[i], y + row * 4, x + col * 6, false, RESET);
+        col++;
+        if (col == 13) {
+            col = 0;
+            row++;
+        }
+
+    }
+    col = 0;
+    row += 2;
+    for (unsigned int i = 0; i < deck->num_cards_discard; i++) {
+        draw_card(deck->discard[i], y + row * 4, x + col * 6, false, RESET);
+        col++;
+        if (col == 13) {
+            col = 0;
+            row++;
+        }
+    }
+}
+// draws whether the position can still be won on the status line
+static void draw_status(WINNABLE_STATUS winnable, int y, int x) {
+    const char *labels[] = {
+        [WINNABLE_NONE]      = "",
+        [WINNABLE_SEARCHING] = "winnable: searching...",
+        [WINNABLE_YES]       = "winnable: yes",
+        [WINNABLE_NO]        = "winnable: no",
+        [WINNABLE_UNKNOWN]   = "winnable: unknown",
+    };
+    char line[STATUS_WIDTH+1];
+    snprintf(line, sizeof(line), "%-*s", STATUS_WIDTH, labels[winnable]);
+    backend->text(y, x, line);
+}
+// returns the index of the card of a stack the hint points at: the lowest card
+// moved from the source, or the top card of the target. Returns -1 if the stack
+// is not part of the hint.
+static int hint_card(const GameState *state, SELECTED_SPOT spot, const CardStack *stack) {
+    if (!state->hint_up) {
+        return -1;
+    }
+    if (state->hint_from == spot) {
+        return spot >= WORKING_0 && spot <= WORKING_6 ? (int)state->hint_index : stack->num_cards-1;
+    }
+    if (state->hint_to == spot) {
+        return stack->num_cards ? stack->num_cards-1 : 0;
+    }
+    return -1;
+}
+// draws the parts of the screen that changed since the last frame
+void draw_screen(Board *board, GameState *state, Screen *screen) {
+    const int solution_pos[NUM_SOLUTION_STACKS][2] = {
+        { SOL_STACK_0_POS }, { SOL_STACK_1_POS }, { SOL_STACK_2_POS }, { SOL_STACK_3_POS }
+    };
+    const int working_pos[NUM_WORKING_STACKS][2] = {
+        { WORK_STACK0_POS }, { WORK_STACK1_POS }, { WORK_STACK2_POS }, { WORK_STACK3_POS },
+        { WORK_STACK4_POS }, { WORK_STACK5_POS }, { WORK_STACK6_POS }
+    };
+
+    screen->cells_written = 0;
+    if (state->help_menu_up) {
+        if (state->dirty) {
+            draw_help_menu();
+            screen->cells_written += HELP_MENU_CELLS;
+        }
+    } else {
+        if (state->dirty & DIRTY_SCREEN) {
+            /* overwrites all characters on screen with blanks */
+            backend->erase();
+            screen->cells_written += backend->lines() * backend->cols();
+            for (int i = 0; i < NUM_WORKING_STACKS; i++) {
+                screen->stack_rows[i] = 0;
+            }
+            state->dirty |= ALL_SPOTS | DIRTY_STATUS;
+            backend->text(4, 40, "h: help");
+            screen->cells_written += 7;
+        }
+
+        for (int i = 0; i < NUM_SOLUTION_STACKS; i++) {
+            SELECTED_SPOT spot = SOLUTION_0+i;
+            if (!(state->dirty & SPOT_BIT(spot))) {
+                continue;
+            }
+            bool hinted = hint_card(state, spot, &board->solution_stacks[i]) >= 0;
+            if (board->solution_stacks[i].num_cards) {
+                int color = state->spot == spot ? GREEN : state->saved_spot == spot ? YELLOW : BLUE;
+                draw_card(stack_top(&board->solution_stacks[i]), solution_pos[i][0], solution_pos[i][1],
+                          state->spot == spot || state->saved_spot == spot || hinted, color);
+            } else {
+                draw_empty_card(solution_pos[i][0], solution_pos[i][1], state->spot == spot || hinted,
+                                state->spot == spot ? GREEN : BLUE);
+            }
+            screen->cells_written += CARD_HEIGHT * CARD_WIDTH;
+        }
+
+        for (int i = 0; i < NUM_WORKING_STACKS; i++) {
+            SELECTED_SPOT spot = WORKING_0+i;
+            if (!(state->dirty & SPOT_BIT(spot))) {
+                continue;
+            }
+            unsigned int rows = stack_rows(&board->working_stacks[i]);
+            draw_stack(&board->working_stacks[i], working_pos[i][0], working_pos[i][1], state->spot == spot, state->saved_spot == spot,
+                       hint_card(state, spot, &board->working_stacks[i]), *state);
+            screen->cells_written += rows * CARD_WIDTH;
+            // blanks whatever was left below the stack when it was taller
+            if (screen->stack_rows[i] > rows) {
+                clear_area(working_pos[i][0]+rows, working_pos[i][1], screen->stack_rows[i]-rows, CARD_WIDTH);
+                screen->cells_written += (screen->stack_rows[i]-rows) * CARD_WIDTH;
+            }
+            screen->stack_rows[i] = rows;
+        }
+
+        if (state->dirty & SPOT_BIT(DECK_STACK)) {
+            draw_deck(&board->deck, DECK_POS, *state);
+            screen->cells_written += 2 * CARD_HEIGHT * CARD_WIDTH;
+        }
+
+        if (state->dirty & DIRTY_STATUS) {
+            draw_status(state->winnable, STATUS_POS);
+            screen->cells_written += STATUS_WIDTH;
+        }
+    }
+
+    state->dirty = 0;
+    screen->total_cells_written += screen->cells_written;
+    screen->frames++;
+
+    // DEBUG ONLY
+    // display_deck(&board->deck, 0, 110);
+    // for (int i = 0; i < 4; i++) {
+    //     display_stack(&board->solution_stacks[i], i*5+20, 70);
+    // }
+    // for (int i = 0; i < 4; i++) {
+    //     display_stack(&board->working_stacks[i], i*5+20, 90);
+    // }
+    // for (int i = 4; i < 7; i++) {
+    //     display_stack(&board->working_stacks[i], (i-4)*5+20, 140);
+    // }
+}
+// draws the help menu over the board
+void draw_help_menu(void) {
+    backend->text( 1, 2, "╔══════════════════════════════════════════════════╗");
+    backend->text( 2, 2, "║                                     x: exit help ║");
+    backend->text( 3, 2, "║ Controls:                                        ║");
+    backend->text( 4, 2, "║ ──────────────────────────────────────────────── ║");
+    backend->text( 5, 2, "║ w:      up                                       ║");
+    backend->text( 6, 2, "║ a:      left                                     ║");
+    backend->text( 7, 2, "║ s:      down                                     ║");
+    backend->text( 8, 2, "║ d:      right                                    ║");
+    backend->text( 9, 2, "║ f:      flip from deck to discard                ║");
+    backend->text(10, 2, "║ space:  select                                   ║");
+    backend->text(11, 2, "║ c:      cancel selection                         ║");
+    backend->text(12, 2, "║ u:      undo last move                           ║");
+    backend->text(13, 2, "║ r:      redo move                                ║");
+    backend->text(14, 2, "║ l:      show/hide latency                        ║");
+    backend->text(15, 2, "║ t:      show/hide hint                           ║");
+    backend->text(16, 2, "║ q:      quit game                                ║");
+    backend->text(17, 2, "║                                                  ║");
+    backend->text(18, 2, "║ Indicators:                                      ║");
+    backend->text(19, 2, "║ ──────────────────────────────────────────────── ║");
+    backend->text(20, 2, "║ yellow border:      selected                     ║");
+    backend->text(21, 2, "║ green border:       current position             ║");
+    backend->text(22, 2, "║ blue border:        hinted move                  ║");
+    backend->text(23, 2, "║ x on card:          empty spot                   ║");
+    backend->text(24, 2, "║ 4 symbols on card:  card present but not visible ║");
+    backend->text(25, 2, "║ ──────────────────────────────────────────────── ║");
+    backend->text(26, 2, "║                                                  ║");
+    backend->text(27, 2, "║ Author: Elliot Wasem        Github: elliot-wasem ║");
+    backend->text(28, 2, "╚══════════════════════════════════════════════════╝");
+}
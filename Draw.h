@@ -0,0 +1,46 @@
+#ifndef __DRAW_H__
+#define __DRAW_H__
+#include <stdbool.h>
+#include "Board.h"
+#include "Card.h"
+#include "Deck.h"
+#include "GameState.h"
+#include "Render.h"
+
+// quick color definitions, for ease of use.
+// colors declared inside main
+#define RED    1
+#define GREEN  2
+#define YELLOW 3
+#define BLUE   4
+#define RESET  5
+
+// what the last frame left on the screen, and how many cells were written to
+// draw it
+typedef struct {
+    unsigned int stack_rows[NUM_WORKING_STACKS];
+    unsigned long cells_written;
+    unsigned long total_cells_written;
+    unsigned long frames;
+} Screen;
+
+// handler struct for all functions that draw cards, stacks, decks and the
+// whole screen through the current render backend
+typedef struct {
+    void (*card)(Card, int y, int x, bool, int color);
+    void (*blank)(int y, int x, bool, int color);
+    void (*empty)(int y, int x, bool, int color);
+    void (*stack)(const CardStack *, int y, int x, bool, bool, int hint_card, GameState);
+    void (*display_stack)(const CardStack *, int y, int x);
+    void (*deck)(const Deck *, int y, int x, GameState);
+    void (*display_deck)(const Deck *, int y, int x);
+    void (*set_backend)(const RenderBackend *);
+    unsigned int (*stack_rows)(const CardStack *);
+    void (*clear_area)(int y, int x, int height, int width);
+    void (*screen)(Board *, GameState *, Screen *);
+    void (*help_menu)(void);
+} DrawFunctions;
+
+const DrawFunctions *get_draw_functions();
+
+#endif /* __DRAW_H__ */
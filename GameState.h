@@ -9,13 +9,37 @@ typedef enum {
     DECK_STACK, NO_SPOT
 } SELECTED_SPOT;
 
-// struct to hold the state of the player's cursor and selection in the game
+// bit for a spot in a set of spots. NO_SPOT's bit stands for the whole screen.
+#define SPOT_BIT(spot) (1u << (spot))
+#define ALL_SPOTS      (SPOT_BIT(NO_SPOT)-1)
+#define DIRTY_SCREEN   SPOT_BIT(NO_SPOT)
+// bit for the status line next to the help label
+#define DIRTY_STATUS   SPOT_BIT(NO_SPOT+1)
+
+// whether the position can still be won, as shown on the status line: not
+// shown at all, still being searched, or the answer of the search
+typedef enum {
+    WINNABLE_NONE, WINNABLE_SEARCHING, WINNABLE_YES, WINNABLE_NO, WINNABLE_UNKNOWN
+} WINNABLE_STATUS;
+
+// struct to hold the state of the player's cursor and selection in the game.
+// "dirty" holds the bits of the spots that changed since the screen was last
+// drawn, so only those are drawn again. "hint_from" and "hint_to" are the
+// spots of the hinted move, NO_SPOT when there is none, and "hint_index" the
+// lowest card it moves out of a working stack.
 typedef struct {
     SELECTED_SPOT spot;
     SELECTED_SPOT saved_spot;
     unsigned int index;
     unsigned int saved_index;
     bool help_menu_up;
+    bool latency_hud_up;
+    bool hint_up;
+    SELECTED_SPOT hint_from;
+    SELECTED_SPOT hint_to;
+    unsigned int hint_index;
+    WINNABLE_STATUS winnable;
+    unsigned int dirty;
 } GameState;
 
 #endif /* __GAME_STATE_H__ */
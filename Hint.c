@@ -0,0 +1,163 @@
+#include "Hint.h"
+#include "Arena.h"
+#include "Board.h"
+#include "MoveGen.h"
+#include "Packed.h"
+#include "Policy.h"
+#include "Random.h"
+#include "Solver.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+bool start_hints(HintEngine *);
+bool search_hint(HintEngine *, const Board *);
+HINT_KIND get_hint(HintEngine *, Move *);
+bool get_result(HintEngine *, SOLVE_RESULT *);
+void stop_hints(HintEngine *);
+
+const HintFunctions hint_functions = {
+    .start=start_hints,
+    .search=search_hint,
+    .hint=get_hint,
+    .result=get_result,
+    .stop=stop_hints
+};
+
+// returns pointer to the handler for hint functions
+const HintFunctions *get_hint_functions() {
+    return &hint_functions;
+}
+
+// keeps the hint found for a position, unless the position changed since
+static void set_hint(HintEngine *engine, uint64_t generation, HINT_KIND kind, Move hint) {
+    pthread_mutex_lock(&engine->lock);
+    if (generation == engine->generation) {
+        engine->kind = kind;
+        engine->hint = hint;
+    }
+    pthread_mutex_unlock(&engine->lock);
+}
+
+// waits for a new position, then gives the heuristic policy's move for it
+// straight away and runs the solver for a better one, until told to quit
+static void *run_hints(void *arg) {
+    HintEngine *engine = arg;
+    const Policy *policy = get_policy_functions()->find("heuristic");
+    Rng rng;
+    get_random_functions()->seed(&rng, 0);
+
+    pthread_mutex_lock(&engine->lock);
+    while (!engine->quit) {
+        if (!engine->has_position || engine->searched_generation == engine->generation) {
+            pthread_cond_wait(&engine->changed, &engine->lock);
+            continue;
+        }
+        uint64_t generation = engine->searched_generation = engine->generation;
+        PackedBoard position = engine->position;
+        atomic_store(&engine->cancel, false);
+        pthread_mutex_unlock(&engine->lock);
+
+        Move moves[MAX_MOVES];
+        unsigned int num_moves = get_move_gen_functions()->generate(&position, moves);
+        if (num_moves) {
+            set_hint(engine, generation, HINT_HEURISTIC, moves[policy->choose(&position, moves, num_moves, &rng)]);
+        }
+        SolverResult result = get_solver_functions()->solve(&position, engine->options, engine->line);
+        if (result.result == SOLVE_WON && result.num_moves) {
+            set_hint(engine, generation, HINT_SOLVED, engine->line[0]);
+        }
+
+        pthread_mutex_lock(&engine->lock);
+        if (generation == engine->generation) {
+            engine->result = result.result;
+            engine->finished = true;
+        }
+    }
+    pthread_mutex_unlock(&engine->lock);
+    return NULL;
+}
+
+// starts the worker thread, which idles until it is given a position.
+// Returns false if it could not be started.
+bool start_hints(HintEngine *engine) {
+    engine->options = get_solver_functions()->default_options();
+    engine->options.max_ms = HINT_MAX_MS;
+    engine->options.trans_table_bits = 20;
+    engine->options.cancel = &engine->cancel;
+    engine->arena = get_arena_functions()->fresh_arena();
+    engine->options.arena = &engine->arena;
+    engine->generation = engine->searched_generation = 0;
+    engine->has_position = engine->quit = false;
+    engine->kind = HINT_NONE;
+    engine->finished = false;
+    engine->result = SOLVE_UNKNOWN;
+    atomic_init(&engine->cancel, false);
+    if ((engine->line = malloc(sizeof(Move) * MAX_SOLUTION_LENGTH)) == NULL) {
+        return false;
+    }
+    pthread_mutex_init(&engine->lock, NULL);
+    pthread_cond_init(&engine->changed, NULL);
+    if (pthread_create(&engine->thread, NULL, run_hints, engine) != 0) {
+        pthread_mutex_destroy(&engine->lock);
+        pthread_cond_destroy(&engine->changed);
+        free(engine->line);
+        return false;
+    }
+    return true;
+}
+
+// has the worker search the board, cancelling the search of the last one.
+// Returns false, and keeps searching, if the position is the same as before.
+bool search_hint(HintEngine *engine, const Board *board) {
+    PackedBoard position = get_packed_functions()->pack(board);
+    pthread_mutex_lock(&engine->lock);
+    if (engine->has_position && memcmp(&position, &engine->position, sizeof(PackedBoard)) == 0) {
+        pthread_mutex_unlock(&engine->lock);
+        return false;
+    }
+    engine->position = position;
+    engine->has_position = true;
+    engine->generation++;
+    engine->kind = HINT_NONE;
+    engine->finished = false;
+    engine->result = SOLVE_UNKNOWN;
+    atomic_store(&engine->cancel, true);
+    pthread_cond_signal(&engine->changed);
+    pthread_mutex_unlock(&engine->lock);
+    return true;
+}
+
+// gives the best move found so far for the current position, and how it was found
+HINT_KIND get_hint(HintEngine *engine, Move *hint) {
+    pthread_mutex_lock(&engine->lock);
+    HINT_KIND kind = engine->kind;
+    *hint = engine->hint;
+    pthread_mutex_unlock(&engine->lock);
+    return kind;
+}
+
+// gives whether the current position can be won, with full knowledge of the
+// face down cards. Returns false while that is still being searched.
+bool get_result(HintEngine *engine, SOLVE_RESULT *result) {
+    pthread_mutex_lock(&engine->lock);
+    bool finished = engine->finished;
+    *result = engine->result;
+    pthread_mutex_unlock(&engine->lock);
+    return finished;
+}
+// cancels any search and waits for the worker thread to finish
+void stop_hints(HintEngine *engine) {
+    pthread_mutex_lock(&engine->lock);
+    engine->quit = true;
+    atomic_store(&engine->cancel, true);
+    pthread_cond_signal(&engine->changed);
+    pthread_mutex_unlock(&engine->lock);
+    pthread_join(engine->thread, NULL);
+    pthread_mutex_destroy(&engine->lock);
+    pthread_cond_destroy(&engine->changed);
+    get_arena_functions()->free(&engine->arena);
+    free(engine->line);
+}
@@ -0,0 +1,52 @@
+#ifndef __HINT_H__
+#define __HINT_H__
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "Arena.h"
+#include "Board.h"
+#include "Packed.h"
+#include "Solver.h"
+
+// longest the solver searches one position, in milliseconds, before giving
+// up on finding a winning line or showing there is none
+#define HINT_MAX_MS 100
+
+// how good the current hint is: none yet, the heuristic policy's pick while
+// the solver runs, or the first move of a line the solver found to win
+typedef enum { HINT_NONE, HINT_HEURISTIC, HINT_SOLVED } HINT_KIND;
+
+// a worker thread searching the current position for the best move. Giving it
+// a new position cancels the search of the old one.
+typedef struct {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    PackedBoard position;
+    uint64_t generation;          // bumped whenever the position changes
+    uint64_t searched_generation; // the last generation the worker took up
+    bool has_position;
+    bool quit;
+    atomic_bool cancel;
+    SolverOptions options;
+    Arena arena;                  // reused by every search, so searching never allocates
+    Move *line;
+    HINT_KIND kind;
+    Move hint;
+    bool finished;                // the search of the current position is over
+    SOLVE_RESULT result;          // what it found: SOLVE_UNKNOWN if it ran out of time
+} HintEngine;
+
+// handler struct for the hint engine
+typedef struct {
+    bool (*start)(HintEngine *);
+    bool (*search)(HintEngine *, const Board *);
+    HINT_KIND (*hint)(HintEngine *, Move *);
+    bool (*result)(HintEngine *, SOLVE_RESULT *);
+    void (*stop)(HintEngine *);
+} HintFunctions;
+
+const HintFunctions *get_hint_functions();
+
+#endif /* __HINT_H__ */
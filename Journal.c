@@ -0,0 +1,139 @@
+#include "Journal.h"
+#include "Board.h"
+#include "Card.h"
+#include "Deck.h"
+#include "Zobrist.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+Journal get_fresh_journal(void);
+void free_journal(Journal *);
+bool journal_apply_move(Journal *, Board *, Move);
+bool undo(Journal *, Board *);
+bool redo(Journal *, Board *);
+Move entry_move(const Board *, JournalEntry);
+
+const JournalFunctions journal_functions = {
+    .fresh_journal=get_fresh_journal,
+    .free=free_journal,
+    .apply_move=journal_apply_move,
+    .undo=undo,
+    .redo=redo,
+    .entry_move=entry_move
+};
+
+// returns pointer to the handler for journal functions
+const JournalFunctions *get_journal_functions() {
+    return &journal_functions;
+}
+
+// gives an empty journal. Entries are allocated as moves are made.
+Journal get_fresh_journal(void) {
+    return (Journal){ .entries=NULL, .num_entries=0, .position=0, .capacity=0 };
+}
+// frees the entries of a journal, leaving it empty
+void free_journal(Journal *journal) {
+    free(journal->entries);
+    *journal = get_fresh_journal();
+}
+
+// returns the stack a move puts cards onto
+static CardStack *to_stack(Board *board, SELECTED_SPOT spot) {
+    return spot <= SOLUTION_3
+        ? &board->solution_stacks[spot-SOLUTION_0]
+        : &board->working_stacks[spot-WORKING_0];
+}
+// returns the move a journal entry records, as played from the board
+Move entry_move(const Board *board, JournalEntry entry) {
+    if (entry.flags & JOURNAL_FLIP) {
+        return (Move){ .type=MOVE_FLIP };
+    }
+    Move move = { .type=MOVE_CARDS, .from=entry.from, .to=entry.to, .index=0 };
+    if (entry.from >= WORKING_0 && entry.from <= WORKING_6) {
+        move.index = board->working_stacks[entry.from-WORKING_0].num_cards - entry.num_cards;
+    }
+    return move;
+}
+
+// applies the move to the board if it is legal, recording it in the journal.
+// Any moves that were taken back can no longer be played again. Returns
+// whether or not the move was applied.
+bool journal_apply_move(Journal *journal, Board *board, Move move) {
+    if (!get_board_functions()->is_legal(board, move)) {
+        return false;
+    }
+    if (journal->position == journal->capacity) {
+        unsigned int capacity = journal->capacity ? journal->capacity * 2 : 64;
+        JournalEntry *entries = realloc(journal->entries, capacity * sizeof(JournalEntry));
+        if (entries == NULL) {
+            return false;
+        }
+        journal->entries = entries;
+        journal->capacity = capacity;
+    }
+
+    JournalEntry entry = { .from=move.from, .to=move.to, .num_cards=1, .flags=0 };
+    if (move.type == MOVE_FLIP) {
+        unsigned int left = board->deck.num_cards;
+        entry = (JournalEntry){ .from=DECK_STACK, .to=DECK_STACK, .num_cards=DRAW_COUNT, .flags=JOURNAL_FLIP };
+        if (left == 0) {
+            entry.flags |= JOURNAL_RECYCLED;
+            left = board->deck.num_cards_discard;
+        }
+        if (left < DRAW_COUNT) {
+            entry.num_cards = left;
+        }
+    } else if (move.from >= WORKING_0 && move.from <= WORKING_6) {
+        const CardStack *from_stack = &board->working_stacks[move.from-WORKING_0];
+        entry.num_cards = from_stack->num_cards - move.index;
+        if (move.index > 0 && !from_stack->cards[move.index-1].is_visible) {
+            entry.flags |= JOURNAL_TURNED_UP;
+        }
+    }
+
+    get_board_functions()->apply_move(board, move);
+    journal->entries[journal->position++] = entry;
+    journal->num_entries = journal->position;
+    return true;
+}
+
+// takes back the last move played. Returns false if there is none.
+bool undo(Journal *journal, Board *board) {
+    const CardStackFunctions *sfuncs = get_stack_functions();
+    const DeckFunctions      *dfuncs = get_deck_functions();
+    if (journal->position == 0) {
+        return false;
+    }
+    JournalEntry entry = journal->entries[--journal->position];
+
+    if (entry.flags & JOURNAL_FLIP) {
+        dfuncs->unflip(&board->deck, entry.num_cards, entry.flags & JOURNAL_RECYCLED);
+    } else if (entry.from == DECK_STACK) {
+        dfuncs->add_to_discard(&board->deck, sfuncs->remove_from_stack(to_stack(board, entry.to)));
+    } else {
+        CardStack *to = to_stack(board, entry.to);
+        CardStack *from = to_stack(board, entry.from);
+        if (entry.flags & JOURNAL_TURNED_UP) {
+            sfuncs->set_visible(from, from->num_cards-1, false);
+        }
+        // the card the moved cards were on is already face up, so moving them
+        // back leaves it as it is
+        sfuncs->move_to_stack(from, to, to->num_cards-entry.num_cards);
+    }
+    assert(get_zobrist_functions()->is_consistent(board));
+    return true;
+}
+
+// plays again the last move taken back. Returns false if there is none.
+bool redo(Journal *journal, Board *board) {
+    if (journal->position == journal->num_entries) {
+        return false;
+    }
+    Move move = entry_move(board, journal->entries[journal->position]);
+    if (!get_board_functions()->apply_move(board, move)) {
+        return false;
+    }
+    journal->position++;
+    return true;
+}
@@ -0,0 +1,43 @@
+#ifndef __JOURNAL_H__
+#define __JOURNAL_H__
+#include <stdbool.h>
+#include <stdint.h>
+#include "Board.h"
+
+// flags for a journal entry
+#define JOURNAL_FLIP      0x01 // the move was a flip
+#define JOURNAL_RECYCLED  0x02 // the flip first turned the discard pile back into the deck
+#define JOURNAL_TURNED_UP 0x04 // the move turned over the card left on top of its working stack
+
+// one move as it was played, in 4 bytes: enough to take it back or play it again
+// without keeping a copy of the board. For a flip, "num_cards" is how many
+// cards it turned over.
+typedef struct {
+    uint8_t from;
+    uint8_t to;
+    uint8_t num_cards;
+    uint8_t flags;
+} JournalEntry;
+
+// the moves of a game in order. The first "position" entries have been played,
+// the rest were taken back and can be played again until a new move is made.
+typedef struct {
+    JournalEntry *entries;
+    unsigned int num_entries;
+    unsigned int position;
+    unsigned int capacity;
+} Journal;
+
+// handler struct for playing moves through a journal
+typedef struct {
+    Journal (*fresh_journal)(void);
+    void (*free)(Journal *);
+    bool (*apply_move)(Journal *, Board *, Move);
+    bool (*undo)(Journal *, Board *);
+    bool (*redo)(Journal *, Board *);
+    Move (*entry_move)(const Board *, JournalEntry);
+} JournalFunctions;
+
+const JournalFunctions *get_journal_functions();
+
+#endif /* __JOURNAL_H__ */
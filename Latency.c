@@ -0,0 +1,89 @@
+#include "Latency.h"
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+uint64_t now(void);
+void record(LatencyHistogram *, uint64_t ns);
+uint64_t percentile(const LatencyHistogram *, double fraction);
+void write_summary(FILE *, const char *name, const LatencyHistogram *);
+
+const LatencyFunctions latency_functions = {
+    .now=now,
+    .record=record,
+    .percentile=percentile,
+    .write_summary=write_summary
+};
+
+// returns pointer to the handler for latency functions
+const LatencyFunctions *get_latency_functions() {
+    return &latency_functions;
+}
+
+// returns the monotonic clock in nanoseconds
+uint64_t now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// returns the bucket a duration is counted in
+static unsigned int bucket_of(uint64_t ns) {
+    if (ns < LATENCY_SUB_BUCKETS) {
+        return ns;
+    }
+    unsigned int msb = 63 - __builtin_clzll(ns);
+    return (msb-2) * LATENCY_SUB_BUCKETS + ((ns >> (msb-3)) & (LATENCY_SUB_BUCKETS-1));
+}
+// returns the smallest duration counted in a bucket
+static uint64_t bucket_start(unsigned int bucket) {
+    if (bucket < LATENCY_SUB_BUCKETS) {
+        return bucket;
+    }
+    unsigned int msb = bucket / LATENCY_SUB_BUCKETS + 2;
+    return (uint64_t)(LATENCY_SUB_BUCKETS + bucket % LATENCY_SUB_BUCKETS) << (msb-3);
+}
+// returns the largest duration counted in a bucket
+static uint64_t bucket_end(unsigned int bucket) {
+    return bucket+1 < LATENCY_BUCKETS ? bucket_start(bucket+1) - 1 : UINT64_MAX;
+}
+
+// counts one duration
+void record(LatencyHistogram *histogram, uint64_t ns) {
+    histogram->buckets[bucket_of(ns)]++;
+    histogram->count++;
+    histogram->total_ns += ns;
+    if (ns > histogram->max_ns) {
+        histogram->max_ns = ns;
+    }
+}
+
+// returns the duration that the given fraction of the recorded durations are at
+// most, to within the size of its bucket. Returns 0 if nothing was recorded.
+uint64_t percentile(const LatencyHistogram *histogram, double fraction) {
+    uint64_t target = fraction * histogram->count, seen = 0;
+    if (histogram->count == 0) {
+        return 0;
+    }
+    for (unsigned int i = 0; i < LATENCY_BUCKETS; i++) {
+        seen += histogram->buckets[i];
+        if (seen > target || seen == histogram->count) {
+            return bucket_end(i) < histogram->max_ns ? bucket_end(i) : histogram->max_ns;
+        }
+    }
+    return histogram->max_ns;
+}
+
+// writes a summary of the histogram, followed by every bucket that has counts
+void write_summary(FILE *file, const char *name, const LatencyHistogram *histogram) {
+    fprintf(file, "%s: %" PRIu64 " samples, mean %" PRIu64 "ns, p50 %" PRIu64 "ns, p90 %" PRIu64
+            "ns, p99 %" PRIu64 "ns, max %" PRIu64 "ns\n", name, histogram->count,
+            histogram->count ? histogram->total_ns / histogram->count : 0,
+            percentile(histogram, 0.5), percentile(histogram, 0.9), percentile(histogram, 0.99), histogram->max_ns);
+    for (unsigned int i = 0; i < LATENCY_BUCKETS; i++) {
+        if (histogram->buckets[i]) {
+            fprintf(file, "  %12" PRIu64 " - %12" PRIu64 "ns  %" PRIu64 "\n", bucket_start(i), bucket_end(i), histogram->buckets[i]);
+        }
+    }
+}
@@ -0,0 +1,30 @@
+#ifndef __LATENCY_H__
+#define __LATENCY_H__
+#include <stdint.h>
+#include <stdio.h>
+
+// durations are counted in buckets of about 12% of their size: values below 8ns
+// get a bucket each, then every power of two is split into 8 buckets
+#define LATENCY_SUB_BUCKETS 8
+#define LATENCY_BUCKETS     ((64-2) * LATENCY_SUB_BUCKETS)
+
+// a histogram of durations in nanoseconds. Recording is a few instructions and
+// never allocates, so it can sit in the middle of the game loop.
+typedef struct {
+    uint64_t buckets[LATENCY_BUCKETS];
+    uint64_t count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+} LatencyHistogram;
+
+// handler struct for timing and latency histograms
+typedef struct {
+    uint64_t (*now)(void);
+    void (*record)(LatencyHistogram *, uint64_t ns);
+    uint64_t (*percentile)(const LatencyHistogram *, double fraction);
+    void (*write_summary)(FILE *, const char *name, const LatencyHistogram *);
+} LatencyFunctions;
+
+const LatencyFunctions *get_latency_functions();
+
+#endif /* __LATENCY_H__ */
@@ -4,75 +4,167 @@
 #include <string.h>
 #include <locale.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
 
+#include "Board.h"
 #include "Card.h"
+#include "Controls.h"
 #include "Deck.h"
+#include "Draw.h"
 #include "GameState.h"
-
-#define DECK_POS        0, 35
-#define SOL_STACK_0_POS 0, 0
-#define SOL_STACK_1_POS 0, 7
-#define SOL_STACK_2_POS 0, 14
-#define SOL_STACK_3_POS 0, 21
-
-#define WORK_STACK0_POS 5, 0
-#define WORK_STACK1_POS 5, 7
-#define WORK_STACK2_POS 5, 14
-#define WORK_STACK3_POS 5, 21
-#define WORK_STACK4_POS 5, 28
-#define WORK_STACK5_POS 5, 35
-#define WORK_STACK6_POS 5, 42
-
-void init_game(Deck *deck, CardStack *solution_stacks, CardStack *working_stacks);
-void draw_screen(Deck *deck, CardStack *solution_stacks, CardStack *working_stacks, GameState *state);
-void handle_keypress(char c, Deck *deck, CardStack *solution_stacks, CardStack *working_stacks, GameState *state);
-void handle_selection(Deck *deck, CardStack *solution_stacks, CardStack *working_stacks, GameState *state);
-void handle_up(Deck *deck, CardStack *solution_stacks, CardStack *working_stacks, GameState *state);
-void handle_down(Deck *deck, CardStack *solution_stacks, CardStack *working_stacks, GameState *state);
-void handle_left(Deck *deck, CardStack *solution_stacks, CardStack *working_stacks, GameState *state);
-void handle_right(Deck *deck, CardStack *solution_stacks, CardStack *working_stacks, GameState *state);
+#include "Hint.h"
+#include "Journal.h"
+#include "Latency.h"
+#include "Random.h"
+#include "Render.h"
+#include "Replay.h"
+
+// how long each part of the game loop takes. "total" runs from getting a key
+// to the frame it caused being painted.
+typedef struct {
+    LatencyHistogram handle;
+    LatencyHistogram complete;
+    LatencyHistogram render;
+    LatencyHistogram total;
+} LoopLatency;
+
+// how often the game wakes up while waiting for a key to see if the search of
+// whether the position can still be won is over, in milliseconds
+#define WINNABLE_POLL_MS 20
+
+// how fast the cards are put away once every card is face up, unless set with --auto-complete-fps
+#define AUTO_COMPLETE_FPS 20
+
+// size of the off-screen grid a script is drawn into
+#define SCRIPT_LINES 40
+#define SCRIPT_COLS  80
+
+// command line options
+typedef struct {
+    uint64_t deal_number;
+    const char *latency_file;
+    const char *script_file;
+    const char *keys_file;
+    const char *replay_file;
+    bool render;
+    bool auto_play;
+    unsigned int auto_complete_fps;
+} Options;
+
+void init_game(Board *board, uint64_t deal_number);
+bool parse_args(int argc, char *argv[], Options *options);
+int run_script(const char *program, const Options *options);
+void write_script_summary(const LoopLatency *latency, bool render);
 void print_state(GameState state);
-bool game_complete(Deck *deck, CardStack *solution_stacks, CardStack *working_stacks, GameState *state);
 void draw_win_splashscreen();
-void draw_help_menu();
+void draw_latency_hud(const LoopLatency *latency, Screen *screen);
+bool write_latency(const char *path, const LoopLatency *latency);
+bool write_replay(const char *path, uint64_t deal_number, const Journal *journal);
+void update_hint(HintEngine *hints, const Board *board, GameState *state);
+bool update_winnable(HintEngine *hints, GameState *state);
+int wait_for_key(HintEngine *hints, GameState *state);
+bool animate_auto_complete(Board *board, Journal *journal, GameState *state, Screen *screen, unsigned int fps);
 
 int main(int argc, char *argv[]) {
 
-    CardStack solution_stacks[4] = {
-        { .num_cards=0 },
-        { .num_cards=0 },
-        { .num_cards=0 },
-        { .num_cards=0 }
-    };
-    CardStack working_stacks[7] = {
-        { .num_cards=0 },
-        { .num_cards=0 },
-        { .num_cards=0 },
-        { .num_cards=0 },
-        { .num_cards=0 },
-        { .num_cards=0 },
-        { .num_cards=0 }
-    };
+    GameState state = { .spot = WORKING_0, .index = 0, .saved_spot = NO_SPOT, .saved_index = 0, .help_menu_up = false, .latency_hud_up = false,
+                        .hint_up = false, .hint_from = NO_SPOT, .hint_to = NO_SPOT, .hint_index = 0, .winnable = WINNABLE_NONE, .dirty = DIRTY_SCREEN };
+    Screen screen = { .cells_written = 0, .total_cells_written = 0, .frames = 0 };
+
+    LoopLatency latency = { 0 };
 
-    GameState state = { .spot = WORKING_0, .index = 0, .saved_spot = NO_SPOT, .saved_index = 0, .help_menu_up = false };
+    const BoardFunctions   *bfuncs = get_board_functions();
+    const ControlFunctions *cfuncs = get_control_functions();
+    const LatencyFunctions *lfuncs = get_latency_functions();
 
-    const DeckFunctions *dfuncs = get_deck_functions();
+    Options options = { .deal_number = get_random_functions()->fresh_seed(), .latency_file = NULL,
+                        .script_file = NULL, .keys_file = NULL, .replay_file = NULL, .render = false, .auto_play = false,
+                        .auto_complete_fps = AUTO_COMPLETE_FPS };
+    if (!parse_args(argc, argv, &options)) {
+        fprintf(stderr, "usage: %s [--deal N] [--latency-log FILE] [--save-replay FILE] [--save-keys FILE] [--auto-play] [--auto-complete-fps N]\n", argv[0]);
+        fprintf(stderr, "       %s [--deal N] [--latency-log FILE] [--save-replay FILE] --script FILE|- [--render]\n", argv[0]);
+        return 1;
+    }
+    if (options.script_file) {
+        return run_script(argv[0], &options);
+    }
+
+    FILE *keys_file = NULL;
+    if (options.keys_file && (keys_file = fopen(options.keys_file, "w")) == NULL) {
+        fprintf(stderr, "%s: could not write %s\n", argv[0], options.keys_file);
+        return 1;
+    }
 
-    Deck deck = dfuncs->fresh_deck();
+    Board board = bfuncs->fresh_board();
+    Journal journal = get_journal_functions()->fresh_journal();
 
-    init_game(&deck, solution_stacks, working_stacks);
+    init_game(&board, options.deal_number);
 
-    char c = '\0';
+    // searches for the best move in the background while waiting for keys.
+    // The game carries on without hints if it cannot be started.
+    HintEngine hints;
+    bool has_hints = get_hint_functions()->start(&hints);
+    if (has_hints) {
+        get_hint_functions()->search(&hints, &board);
+        update_winnable(&hints, &state);
+    }
+
+    int c = '\0';
     bool is_game_complete = false;
+    uint64_t key_time = 0;
 
     while (!is_game_complete && c != 'q') {
-        draw_screen(&deck, solution_stacks, working_stacks, &state);
-        c = getch();
-        handle_keypress(c, &deck, solution_stacks, working_stacks, &state);
-        is_game_complete = game_complete(&deck, solution_stacks, working_stacks, &state);
+        uint64_t render_start = lfuncs->now();
+        get_draw_functions()->screen(&board, &state, &screen);
+        if (state.latency_hud_up && !state.help_menu_up) {
+            draw_latency_hud(&latency, &screen);
+        }
+        refresh();
+        uint64_t render_end = lfuncs->now();
+        lfuncs->record(&latency.render, render_end - render_start);
+        if (key_time) {
+            lfuncs->record(&latency.total, render_end - key_time);
+        }
+
+        c = wait_for_key(&hints, &state);
+        // woken up to show the search's answer rather than by a key. The hint
+        // up for the position is the answer's best move now too.
+        if (c == ERR) {
+            update_hint(&hints, &board, &state);
+            key_time = 0;
+            continue;
+        }
+        if (keys_file) {
+            fputc(c, keys_file);
+        }
+
+        key_time = lfuncs->now();
+        unsigned int played = journal.position;
+        cfuncs->keypress(c, &board, &journal, &state);
+        // after a move, but not an undo or redo, sends what it safely can to the solution stacks
+        if (options.auto_play && c != 'r' && journal.position > played) {
+            while (cfuncs->auto_play(&board, &journal, &state)) {
+                continue;
+            }
+        }
+        if (has_hints) {
+            update_hint(&hints, &board, &state);
+            update_winnable(&hints, &state);
+        }
+        uint64_t handle_end = lfuncs->now();
+        is_game_complete = cfuncs->game_complete(&board, &state);
+        lfuncs->record(&latency.handle, handle_end - key_time);
+        lfuncs->record(&latency.complete, lfuncs->now() - handle_end);
+
+        // once all that is left is putting the cards away, does that for the player
+        if (!is_game_complete && animate_auto_complete(&board, &journal, &state, &screen, options.auto_complete_fps)) {
+            is_game_complete = cfuncs->game_complete(&board, &state);
+            key_time = 0;
+        }
     }
 
-    draw_screen(&deck, solution_stacks, working_stacks, &state);
+    get_draw_functions()->screen(&board, &state, &screen);
 
     if (is_game_complete) {
         draw_win_splashscreen();
@@ -80,32 +172,180 @@ int main(int argc, char *argv[]) {
     }
 
     endwin();
+    if (has_hints) {
+        get_hint_functions()->stop(&hints);
+    }
+    if (options.replay_file && !write_replay(options.replay_file, options.deal_number, &journal)) {
+        fprintf(stderr, "%s: could not write %s\n", argv[0], options.replay_file);
+    }
+    get_journal_functions()->free(&journal);
+    if (keys_file && fclose(keys_file) != 0) {
+        fprintf(stderr, "%s: could not write %s\n", argv[0], options.keys_file);
+    }
+    if (options.latency_file && !write_latency(options.latency_file, &latency)) {
+        fprintf(stderr, "%s: could not write %s\n", argv[0], options.latency_file);
+    }
+
+    // lets the player replay the same deal with --deal
+    printf("deal %" PRIu64 "\n", options.deal_number);
+    printf("%lu frames, %lu cells written (%.1f per frame)\n", screen.frames, screen.total_cells_written,
+           screen.frames ? (double)screen.total_cells_written / screen.frames : 0.0);
 
     return 0;
 }
 
-// initializes the state of the game
-void init_game(Deck *deck, CardStack *solution_stacks, CardStack *working_stacks) {
-    const DeckFunctions      *dfuncs = get_deck_functions();
-    const CardStackFunctions *sfuncs = get_stack_functions();
+// reads the command line options. Returns false if they are not valid.
+bool parse_args(int argc, char *argv[], Options *options) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--deal") == 0 && i+1 < argc) {
+            char *end;
+            options->deal_number = strtoull(argv[++i], &end, 10);
+            if (*end != '\0') {
+                return false;
+            }
+        } else if (strcmp(argv[i], "--latency-log") == 0 && i+1 < argc) {
+            options->latency_file = argv[++i];
+        } else if (strcmp(argv[i], "--script") == 0 && i+1 < argc) {
+            options->script_file = argv[++i];
+        } else if (strcmp(argv[i], "--save-replay") == 0 && i+1 < argc) {
+            options->replay_file = argv[++i];
+        } else if (strcmp(argv[i], "--save-keys") == 0 && i+1 < argc) {
+            options->keys_file = argv[++i];
+        } else if (strcmp(argv[i], "--auto-complete-fps") == 0 && i+1 < argc) {
+            char *end;
+            options->auto_complete_fps = strtoul(argv[++i], &end, 10);
+            if (*end != '\0') {
+                return false;
+            }
+        } else if (strcmp(argv[i], "--auto-play") == 0) {
+            options->auto_play = true;
+        } else if (strcmp(argv[i], "--render") == 0) {
+            options->render = true;
+        } else {
+            return false;
+        }
+    }
+    // rendering off-screen only applies to scripts, and saving keys only to a terminal
+    if (options->script_file ? options->keys_file != NULL : options->render) {
+        return false;
+    }
+    return true;
+}
 
-    // necessary for unicode display
-    setlocale(LC_ALL, "");
+// plays the deal by feeding the keys of a script file ("-" for stdin) through
+// the same handlers as the terminal, without needing one. Each key is drawn
+// into an off-screen grid if "render" is set. Stops at the end of the script,
+// on 'q' or when the game is won, then prints the final screen and how long
+// the keys took. Returns the exit status.
+int run_script(const char *program, const Options *options) {
+    const ControlFunctions *cfuncs = get_control_functions();
+    const DrawFunctions *dfuncs = get_draw_functions();
+    const LatencyFunctions *lfuncs = get_latency_functions();
+    const MemoryRenderFunctions *mfuncs = get_memory_render_functions();
+
+    FILE *script = strcmp(options->script_file, "-") == 0 ? stdin : fopen(options->script_file, "r");
+    if (script == NULL) {
+        fprintf(stderr, "%s: could not read %s\n", program, options->script_file);
+        return 1;
+    }
+    if (!mfuncs->init(SCRIPT_LINES, SCRIPT_COLS)) {
+        fprintf(stderr, "%s: out of memory\n", program);
+        return 1;
+    }
+    dfuncs->set_backend(mfuncs->backend);
 
-    // shuffle
-    dfuncs->shuffle(deck);
+    GameState state = { .spot = WORKING_0, .index = 0, .saved_spot = NO_SPOT, .saved_index = 0, .help_menu_up = false, .latency_hud_up = false,
+                        .hint_up = false, .hint_from = NO_SPOT, .hint_to = NO_SPOT, .hint_index = 0, .winnable = WINNABLE_NONE, .dirty = DIRTY_SCREEN };
+    Screen screen = { .cells_written = 0, .total_cells_written = 0, .frames = 0 };
+    LoopLatency latency = { 0 };
+    Board board = get_board_functions()->fresh_board();
+    Journal journal = get_journal_functions()->fresh_journal();
+    get_board_functions()->deal(&board, options->deal_number);
 
-    // initialize working stacks by taking from deck
-    for (int i = 6; i >= 0; i--) {
-        for (int j = i; j < 7; j++) {
-            Card c = dfuncs->remove_card(deck);
-            c.is_visible = false;
-            sfuncs->add_to_stack(&working_stacks[j], c);
+    unsigned long num_keys = 0;
+    bool is_game_complete = false;
+    int c = '\0';
+    while (!is_game_complete && c != 'q' && (c = getc(script)) != EOF) {
+        // lets scripts be split over lines
+        if (c == '\n' || c == '\r') {
+            continue;
         }
+        num_keys++;
+        uint64_t key_time = lfuncs->now();
+        unsigned int played = journal.position;
+        cfuncs->keypress(c, &board, &journal, &state);
+        if (options->auto_play && c != 'r' && journal.position > played) {
+            while (cfuncs->auto_play(&board, &journal, &state)) {
+                continue;
+            }
+        }
+        // the cards are put away at once at the end of the game, with no animation
+        while (cfuncs->auto_complete(&board, &journal, &state)) {
+            continue;
+        }
+        uint64_t handle_end = lfuncs->now();
+        is_game_complete = cfuncs->game_complete(&board, &state);
+        uint64_t complete_end = lfuncs->now();
+        lfuncs->record(&latency.handle, handle_end - key_time);
+        lfuncs->record(&latency.complete, complete_end - handle_end);
+        if (options->render) {
+            dfuncs->screen(&board, &state, &screen);
+            lfuncs->record(&latency.render, lfuncs->now() - complete_end);
+        }
+        lfuncs->record(&latency.total, lfuncs->now() - key_time);
+    }
+    if (script != stdin) {
+        fclose(script);
+    }
+
+    state.dirty |= DIRTY_SCREEN;
+    dfuncs->screen(&board, &state, &screen);
+    mfuncs->write(stdout, false);
+    printf("deal %" PRIu64 "\n", options->deal_number);
+    printf("%lu keys, %u moves, %s\n", num_keys, journal.position,
+           is_game_complete ? "won" : c == 'q' ? "quit" : "end of script");
+    write_script_summary(&latency, options->render);
+
+    int status = 0;
+    if (options->latency_file && !write_latency(options->latency_file, &latency)) {
+        fprintf(stderr, "%s: could not write %s\n", program, options->latency_file);
+        status = 1;
     }
-    for (int i = 0; i < 7; i++) {
-        working_stacks[i].cards[working_stacks[i].num_cards-1].is_visible = true;
+    if (options->replay_file && !write_replay(options->replay_file, options->deal_number, &journal)) {
+        fprintf(stderr, "%s: could not write %s\n", program, options->replay_file);
+        status = 1;
     }
+    get_journal_functions()->free(&journal);
+    mfuncs->free();
+    return status;
+}
+// prints the mean, p50 and p99 time per key of each part of a script run
+void write_script_summary(const LoopLatency *latency, bool render) {
+    const LatencyFunctions *lfuncs = get_latency_functions();
+    const struct { const char *name; const LatencyHistogram *histogram; } parts[] = {
+        { "handle_keypress", &latency->handle },
+        { "game_complete",   &latency->complete },
+        { "draw_screen",     render ? &latency->render : NULL },
+        { "total",           &latency->total }
+    };
+    for (unsigned int i = 0; i < sizeof(parts) / sizeof(parts[0]); i++) {
+        const LatencyHistogram *histogram = parts[i].histogram;
+        if (histogram == NULL) {
+            continue;
+        }
+        printf("%-16s mean %8.1fns  p50 %8" PRIu64 "ns  p99 %8" PRIu64 "ns  max %8" PRIu64 "ns\n", parts[i].name,
+               histogram->count ? (double)histogram->total_ns / histogram->count : 0.0,
+               lfuncs->percentile(histogram, 0.5), lfuncs->percentile(histogram, 0.99), histogram->max_ns);
+    }
+}
+
+// initializes the state of the game
+void init_game(Board *board, uint64_t deal_number) {
+    // necessary for unicode display
+    setlocale(LC_ALL, "");
+
+    // shuffle and deal the working stacks
+    get_board_functions()->deal(board, deal_number);
 
     /* initialize screen */
     initscr();
@@ -128,617 +368,13 @@ void init_game(Deck *deck, CardStack *solution_stacks, CardStack *working_stacks
     init_pair(YELLOW, COLOR_YELLOW, COLOR_BLACK);
     init_pair(BLUE,   COLOR_BLUE,   COLOR_BLACK);
     init_pair(RESET,  COLOR_WHITE,  COLOR_BLACK);
-}
-// draws the screen of the game
-void draw_screen(Deck *deck, CardStack *solution_stacks, CardStack *working_stacks, GameState *state) {
-    const CardFunctions      *cfuncs = get_card_functions();
-    const CardStackFunctions *sfuncs = get_stack_functions();
-    if (state->help_menu_up) {
-        draw_help_menu();
-        return;
-    }
-
-    /* overwrites all characters on screen with blanks */
-    erase();
-    int color = RESET;
 
-    if (solution_stacks[SOLUTION_0].num_cards) {
-        if (state->spot == SOLUTION_0) {
-            color = GREEN;
-        } else if (state->saved_spot == SOLUTION_0) {
-            color = YELLOW;
-        }
-        cfuncs->draw(sfuncs->top(solution_stacks[0]), SOL_STACK_0_POS, state->spot == SOLUTION_0 || state->saved_spot == SOLUTION_0, color);
-    } else {
-        cfuncs->draw_empty(SOL_STACK_0_POS, state->spot == SOLUTION_0);
-    }
-    if (solution_stacks[SOLUTION_1].num_cards) {
-        if (state->spot == SOLUTION_1) {
-            color = GREEN;
-        } else if (state->saved_spot == SOLUTION_1) {
-            color = YELLOW;
-        }
-        cfuncs->draw(sfuncs->top(solution_stacks[1]), SOL_STACK_1_POS, state->spot == SOLUTION_1 || state->saved_spot == SOLUTION_1, color);
-    } else {
-        cfuncs->draw_empty(SOL_STACK_1_POS, state->spot == SOLUTION_1);
-    }
-    if (solution_stacks[SOLUTION_2].num_cards) {
-        if (state->spot == SOLUTION_2) {
-            color = GREEN;
-        } else if (state->saved_spot == SOLUTION_2) {
-            color = YELLOW;
-        }
-        cfuncs->draw(sfuncs->top(solution_stacks[2]), SOL_STACK_2_POS, state->spot == SOLUTION_2 || state->saved_spot == SOLUTION_2, color);
-    } else {
-        cfuncs->draw_empty(SOL_STACK_2_POS, state->spot == SOLUTION_2);
-    }
-    if (solution_stacks[SOLUTION_3].num_cards) {
-        if (state->spot == SOLUTION_3) {
-            color = GREEN;
-        } else if (state->saved_spot == SOLUTION_3) {
-            color = YELLOW;
-        }
-        cfuncs->draw(sfuncs->top(solution_stacks[3]), SOL_STACK_3_POS, state->spot == SOLUTION_3 || state->saved_spot == SOLUTION_3, color);
-    } else {
-        cfuncs->draw_empty(SOL_STACK_3_POS, state->spot == SOLUTION_3);
-    }
-
-    sfuncs->draw(working_stacks[0], WORK_STACK0_POS, state->spot == WORKING_0, state->saved_spot == WORKING_0, *state);
-    sfuncs->draw(working_stacks[1], WORK_STACK1_POS, state->spot == WORKING_1, state->saved_spot == WORKING_1, *state);
-    sfuncs->draw(working_stacks[2], WORK_STACK2_POS, state->spot == WORKING_2, state->saved_spot == WORKING_2, *state);
-    sfuncs->draw(working_stacks[3], WORK_STACK3_POS, state->spot == WORKING_3, state->saved_spot == WORKING_3, *state);
-    sfuncs->draw(working_stacks[4], WORK_STACK4_POS, state->spot == WORKING_4, state->saved_spot == WORKING_4, *state);
-    sfuncs->draw(working_stacks[5], WORK_STACK5_POS, state->spot == WORKING_5, state->saved_spot == WORKING_5, *state);
-    sfuncs->draw(working_stacks[6], WORK_STACK6_POS, state->spot == WORKING_6, state->saved_spot == WORKING_6, *state);
-
-    const DeckFunctions      *dfuncs = get_deck_functions();
-    dfuncs->draw(*deck, DECK_POS, *state);
-
-    mvprintw(4, 40, "h: help");
-
-    // DEBUG ONLY
-    // dfuncs->display(*deck, 0, 110);
-    // for (int i = 0; i < 4; i++) {
-    //     sfuncs->display(solution_stacks[i], i*5+20, 70);
-    // }
-    // for (int i = 0; i < 4; i++) {
-    //     sfuncs->display(working_stacks[i], i*5+20, 90);
-    // }
-    // for (int i = 4; i < 7; i++) {
-    //     sfuncs->display(working_stacks[i], (i-4)*5+20, 140);
-    // }
-}
-// key press handler
-void handle_keypress(char c, Deck *deck, CardStack *solution_stacks, CardStack *working_stacks, GameState *state) {
-    if (state->help_menu_up) {
-        if (c == 'x') {
-            state->help_menu_up = false;
-        } else {
-            return;
-        }
-    }
-    switch (c) {
-        case 'h':
-            state->help_menu_up = true;
-            break;
-        case 'w':
-            handle_up(deck, solution_stacks, working_stacks, state);
-            break;
-        case 'a':
-            handle_left(deck, solution_stacks, working_stacks, state);
-            break;
-        case 'd':
-            handle_right(deck, solution_stacks, working_stacks, state);
-            break;
-        case 's':
-            handle_down(deck, solution_stacks, working_stacks, state);
-            break;
-        case 'f':
-            get_deck_functions()->flip(deck);
-            state->saved_spot = NO_SPOT;
-            state->saved_index = 0;
-            break;
-        case 'c':
-            state->saved_spot = NO_SPOT;
-            state->saved_index = 0;
-            break;
-        case ' ':
-            handle_selection(deck, solution_stacks, working_stacks, state);
-            break;
-        case 'q':
-            break;
-        default:
-            break;
-    }
-}
-// handles a player pressing space to make a selection
-void handle_selection(Deck *deck, CardStack *solution_stacks, CardStack *working_stacks, GameState *state) {
-    const CardStackFunctions *sfuncs = get_stack_functions();
-    const CardFunctions *cfuncs = get_card_functions();
-    const DeckFunctions *dfuncs = get_deck_functions();
-    if (state->saved_spot == NO_SPOT) {
-        state->saved_spot  = state->spot;
-        state->saved_index = state->index;
-    } else {
-        switch (state->spot) {
-        case DECK_STACK:
-            state->saved_spot = state->spot;
-            state->saved_index = state->index;
-            break;
-        case WORKING_0:
-        case WORKING_1:
-        case WORKING_2:
-        case WORKING_3:
-        case WORKING_4:
-        case WORKING_5:
-        case WORKING_6:
-            switch(state->saved_spot) {
-            case SOLUTION_0:
-            case SOLUTION_1:
-            case SOLUTION_2:
-            case SOLUTION_3:
-            {
-                // solution to working
-                CardStack *from_stack = &solution_stacks[state->saved_spot];
-                unsigned int from_idx = from_stack->num_cards-1;
-                CardStack *to_stack = &working_stacks[state->spot-WORKING_0];
-                if (sfuncs->is_empty(*to_stack)) {
-                    // empty target stack
-                    if (from_stack->cards[from_idx].value != VALUE_KING) {
-                        // not king, can't put it in an empty spot
-                        state->spot = state->saved_spot;
-                        state->index = state->saved_index;
-                        state->saved_spot = NO_SPOT;
-                        state->saved_index = 0;
-                    } else {
-                        sfuncs->move_to_stack(to_stack, from_stack, from_idx);
-                        state->saved_spot = NO_SPOT;
-                        state->saved_index = 0;
-                    }
-                } else {
-                    // nonempty target stack
-                    Card from_card = from_stack->cards[from_idx];
-                    Card to_card = sfuncs->top(*to_stack);
-                    if (cfuncs->is_stackable_regular(to_card, from_card)) {
-                        sfuncs->move_to_stack(to_stack, from_stack, from_idx);
-                        state->index++;
-                        state->saved_spot = NO_SPOT;
-                        state->saved_index = 0;
-                    } else {
-                        state->saved_spot = state->spot;
-                        state->saved_index = state->index;
-                    }
-                }
-                break;
-            }
-            case WORKING_0:
-            case WORKING_1:
-            case WORKING_2:
-            case WORKING_3:
-            case WORKING_4:
-            case WORKING_5:
-            case WORKING_6:
-            {
-                // working to working
-                CardStack *from_stack = &working_stacks[state->saved_spot-WORKING_0];
-                unsigned int from_idx = state->saved_index;
-                CardStack *to_stack = &working_stacks[state->spot-WORKING_0];
-                if (sfuncs->is_empty(*to_stack)) {
-                    // empty target stack
-                    if (from_stack->cards[from_idx].value != VALUE_KING) {
-                        // not king, can't put it in an empty spot
-                        state->spot = state->saved_spot;
-                        state->index = state->saved_index;
-                        state->saved_spot = NO_SPOT;
-                        state->saved_index = 0;
-                    } else {
-                        sfuncs->move_to_stack(to_stack, from_stack, from_idx);
-                        state->saved_spot = NO_SPOT;
-                        state->saved_index = 0;
-                    }
-                } else {
-                    // nonempty target stack
-                    Card from_card = from_stack->cards[from_idx];
-                    Card to_card = sfuncs->top(*to_stack);
-                    if (cfuncs->is_stackable_regular(to_card, from_card)) {
-                        sfuncs->move_to_stack(to_stack, from_stack, from_idx);
-                        state->index++;
-                        state->saved_spot = NO_SPOT;
-                        state->saved_index = 0;
-                    } else {
-                        state->saved_spot = state->spot;
-                        state->saved_index = state->index;
-                    }
-
-                }
-                break;
-            }
-            case DECK_STACK:
-            {
-                // deck to working
-                CardStack *work_stack = &working_stacks[state->spot-WORKING_0];
-                if (sfuncs->is_empty(*work_stack)) {
-                    // empty work stack
-                    if (deck->discard[deck->num_cards_discard-1].value != VALUE_KING) {
-                        // not a king, so go back to deck stack
-                        state->spot = DECK_STACK;
-                        state->index = 0;
-                        state->saved_spot = NO_SPOT;
-                        state->saved_index = 0;
-                    } else {
-                        // is a king, so move it
-                        deck->discard[deck->num_cards_discard-1].is_visible = true;
-                        sfuncs->add_to_stack(work_stack, dfuncs->remove_from_stack(deck));
-                        state->saved_spot = NO_SPOT;
-                        state->saved_index = 0;
-                    }
-                } else {
-                    // nonempty work stack
-                    Card working_top = sfuncs->top(*work_stack);
-                    if (cfuncs->is_stackable_regular(working_top, deck->discard[deck->num_cards_discard-1])) {
-                        sfuncs->add_to_stack(work_stack, dfuncs->remove_from_stack(deck));
-                        state->index++;
-                        state->saved_spot = NO_SPOT;
-                        state->saved_index = 0;
-                    } else {
-                        // not compatible, stay on new stack
-                        state->saved_spot = state->spot;
-                        state->saved_index = state->index;
-                    }
-                }
-                break;
-            }
-            default:
-                break;
-            }
-            break;
-        case SOLUTION_0:
-        case SOLUTION_1:
-        case SOLUTION_2:
-        case SOLUTION_3:
-            switch(state->saved_spot) {
-            case WORKING_0:
-            case WORKING_1:
-            case WORKING_2:
-            case WORKING_3:
-            case WORKING_4:
-            case WORKING_5:
-            case WORKING_6:
-            {
-                // working to solution
-                CardStack *from_stack = &working_stacks[state->saved_spot-WORKING_0];
-                unsigned int from_idx = state->saved_index;
-                CardStack *to_stack = &solution_stacks[state->spot];
-                if (sfuncs->is_empty(*to_stack)) {
-                    // empty target stack
-                    if (from_stack->cards[from_idx].value != VALUE_ACE) {
-                        // not ace, can't put it in an empty spot
-                        state->spot = state->saved_spot;
-                        state->index = state->saved_index;
-                        state->saved_spot = NO_SPOT;
-                        state->saved_index = 0;
-                    } else {
-                        sfuncs->move_to_stack(to_stack, from_stack, from_idx);
-                        state->saved_spot = NO_SPOT;
-                        state->saved_index = 0;
-                    }
-                } else {
-                    // nonempty target stack
-                    Card from_card = from_stack->cards[from_idx];
-                    Card to_card = sfuncs->top(*to_stack);
-                    if (cfuncs->is_stackable_solution(to_card, from_card)) {
-                        sfuncs->move_to_stack(to_stack, from_stack, from_idx);
-                        state->index++;
-                        state->saved_spot = NO_SPOT;
-                        state->saved_index = 0;
-                    } else {
-                        state->spot = state->saved_spot;
-                        state->index = state->saved_index;
-                        //state->saved_spot = state->spot;
-                        //state->saved_index = state->index;
-                    }
-                }
-                break;
-            }
-            case DECK_STACK:
-            {
-                // deck to solution
-                CardStack *to_stack = &solution_stacks[state->spot];
-                if (sfuncs->is_empty(*to_stack)) {
-                    // empty target stack
-                    if (deck->discard[deck->num_cards_discard-1].value != VALUE_ACE) {
-                        // not ace, can't put it in an empty spot
-                        state->spot = state->saved_spot;
-                        state->index = state->saved_index;
-                        state->saved_spot = NO_SPOT;
-                        state->saved_index = 0;
-                    } else {
-                        sfuncs->add_to_stack(to_stack, dfuncs->remove_from_stack(deck));
-                        state->saved_spot = NO_SPOT;
-                        state->saved_index = 0;
-                    }
-                } else {
-                    // nonempty target stack
-                    Card from_card = deck->discard[deck->num_cards_discard-1];
-                    Card to_card = sfuncs->top(*to_stack);
-                    if (cfuncs->is_stackable_solution(to_card, from_card)) {
-                        sfuncs->add_to_stack(to_stack, dfuncs->remove_from_stack(deck));
-                        state->index++;
-                        state->saved_spot = NO_SPOT;
-                        state->saved_index = 0;
-                    } else {
-                        state->saved_spot = state->spot;
-                        state->saved_index = state->index;
-                    }
-                }
-                break;
-            }
-            break;
-            default:
-                state->saved_spot = state->spot;
-                state->saved_index = state->index;
-                break;
-            }
-        default:
-            break;
-        }
-    }
-}
-// handles the player pressing w to move up
-void handle_up(Deck *deck, CardStack *solution_stacks, CardStack *working_stacks, GameState *state) {
-    const CardStackFunctions *sfuncs = get_stack_functions();
-    switch (state->spot) {
-        // cannot move up from these
-        case DECK_STACK:
-        case SOLUTION_0:
-        case SOLUTION_1:
-        case SOLUTION_2:
-        case SOLUTION_3:
-            break;
-        case WORKING_0:
-        case WORKING_1:
-        case WORKING_2:
-        case WORKING_3:
-        case WORKING_4:
-        {
-            // tries to move upward to the solution stack above it
-            unsigned int stack_index = state->spot - WORKING_0;
-            Card card = working_stacks[stack_index].cards[state->index];
-            if (state->index == sfuncs->lowest_visible_index(working_stacks[stack_index])) {
-                // adjust for WORKING_4 being to the side of SOLUTION_3
-                if (stack_index == SOLUTION_3+1) { stack_index--; }
-                if (solution_stacks[SOLUTION_0+stack_index].num_cards != 0 || state->saved_spot != NO_SPOT) {
-                    state->spot = SOLUTION_0+stack_index;
-                } else {
-                    for (int i = SOLUTION_0; i <= SOLUTION_3; i++) {
-                        if (solution_stacks[i].num_cards != 0) {
-                            state->spot = i;
-                            state->index = 0;
-                            break;
-                        }
-                    }
-                }
-            } else if (card.is_visible) {
-                Card prev_card = working_stacks[stack_index].cards[state->index-1];
-                if (prev_card.is_visible) {
-                    state->index--;
-                } else {
-                    state->spot = SOLUTION_0+stack_index;
-                    // adjust for WORKING_4 being to the side of SOLUTION_3
-                    if (stack_index == 4) { state->spot--; };
-                }
-            }
-            break;
-        }
-        case WORKING_5:
-        case WORKING_6:
-        {
-            unsigned int stack_index = state->spot - WORKING_0;
-            Card card = working_stacks[stack_index].cards[state->index];
-            if (state->index == 0) {
-                if (deck->num_cards_discard != 0) {
-                    state->spot = DECK_STACK;
-                }
-            } else if (card.is_visible) {
-                Card prev_card = working_stacks[stack_index].cards[state->index-1];
-                if (prev_card.is_visible) {
-                    state->index--;
-                } else {
-                    if (deck->num_cards_discard != 0) {
-                        state->spot = DECK_STACK;
-                    }
-                }
-            }
-            break;
-        }
-        default:
-            break;
-    }
-}
-// handles the player pressing s to move down
-void handle_down(Deck *deck, CardStack *solution_stacks, CardStack *working_stacks, GameState *state) {
-    const CardStackFunctions *sfuncs = get_stack_functions();
-    switch (state->spot) {
-        // tries to move below
-        case DECK_STACK:
-        {
-            // moves to one of the two right-most working stacks to the lowest (visually highest)
-            // visible index
-            if (!sfuncs->is_empty(working_stacks[5])) {
-                state->spot  = WORKING_5;
-                state->index = sfuncs->lowest_visible_index(working_stacks[5]);
-            } else if (!sfuncs->is_empty(working_stacks[6])) {
-                state->spot  = WORKING_6;
-                state->index = sfuncs->lowest_visible_index(working_stacks[6]);
-            } else if (state->saved_spot != NO_SPOT) {
-                // if neither 5 nor 6 have cards and
-                // if a selection has been made, then moves to 5 even if its empty
-                state->spot  = WORKING_5;
-                state->index = sfuncs->lowest_visible_index(working_stacks[5]);
-            }
-            break;
-        }
-        case SOLUTION_0:
-        case SOLUTION_1:
-        case SOLUTION_2:
-        case SOLUTION_3:
-        {
-            // tries moving to working stack immediately below to visually highest/numerically
-            // lowest index
-            if (!sfuncs->is_empty(working_stacks[state->spot]) || state->saved_spot != NO_SPOT) {
-                state->spot = state->spot + WORKING_0;
-                state->index = sfuncs->lowest_visible_index(working_stacks[state->spot-WORKING_0]);
-            } else {
-                // if that fails, goes to the ordinally lowest stack
-                sfuncs->go_to_lowest_stack(solution_stacks, working_stacks, state);
-                state->index = sfuncs->lowest_visible_index(working_stacks[state->spot-WORKING_0]);
-            }
-            break;
-        }
-        case WORKING_0:
-        case WORKING_1:
-        case WORKING_2:
-        case WORKING_3:
-        case WORKING_4:
-        case WORKING_5:
-        case WORKING_6:
-        {
-            // tries to move downward on the stack its on
-            unsigned int which_stack = state->spot - WORKING_0;
-            if (state->index < sfuncs->highest_visible_index(working_stacks[which_stack])) {
-                state->index++;
-            }
-            break;
-        }
-        default:
-            break;
-    }
-}
-// handles the player pressing a to move left
-void handle_left(Deck *deck, CardStack *solution_stacks, CardStack *working_stacks, GameState *state) {
-    const CardStackFunctions *sfuncs = get_stack_functions();
-    switch (state->spot) {
-        // moves 1 left if possible, otherwise trying more
-        case DECK_STACK:
-            if (!sfuncs->is_empty(solution_stacks[SOLUTION_3]) || state->saved_spot != NO_SPOT) {
-                state->spot = SOLUTION_3;
-                break;
-            }
-        // moves 1 left if possible, otherwise trying more
-        case SOLUTION_3:
-            if (!sfuncs->is_empty(solution_stacks[SOLUTION_2]) || state->saved_spot != NO_SPOT) {
-                state->spot = SOLUTION_2;
-                break;
-            }
-        // moves 1 left if possible, otherwise trying more
-        case SOLUTION_2:
-            if (!sfuncs->is_empty(solution_stacks[SOLUTION_1]) || state->saved_spot != NO_SPOT) {
-                state->spot = SOLUTION_1;
-                break;
-            }
-        // moves 1 left if possible, otherwise trying more
-        case SOLUTION_1:
-            if (!sfuncs->is_empty(solution_stacks[SOLUTION_0]) || state->saved_spot != NO_SPOT) {
-                state->spot = SOLUTION_0;
-                break;
-            }
-        // moves 1 left if possible, otherwise not moving
-        case SOLUTION_0:
-            break;
-        case WORKING_6:
-        case WORKING_5:
-        case WORKING_4:
-        case WORKING_3:
-        case WORKING_2:
-        case WORKING_1:
-        case WORKING_0:
-        {
-            do {
-                // move left until a stack with 1 or more is found, unless a selection has been made, in
-                // which case it will also move onto empty spots
-                state->spot = state->spot == WORKING_0 ? WORKING_6 : state->spot-1;
-            } while (state->saved_spot == NO_SPOT && sfuncs->is_empty(working_stacks[state->spot-WORKING_0]));
-            // gets the index of the stack landed upon
-            int stack_idx = state->spot-WORKING_0;
-            // gets the highest and lowest visible indexes in the stack
-            int highest_idx = sfuncs->highest_visible_index(working_stacks[stack_idx]);
-            int lowest_idx = sfuncs->lowest_visible_index(working_stacks[stack_idx]);
-            // if index is outside range of low-high, goes to the closest end
-            if (state->index < lowest_idx) {
-                state->index = lowest_idx;
-            } else if (state->index > highest_idx) {
-                state->index = highest_idx;
-            }
-            break;
-        }
-        default:
-            break;
-    }
-}
-// handles the player pressing d to move right
-void handle_right(Deck *deck, CardStack *solution_stacks, CardStack *working_stacks, GameState *state) {
-    const CardStackFunctions *sfuncs = get_stack_functions();
-    switch (state->spot) {
-        // moves 1 right if possible, otherwise trying more
-        case SOLUTION_0:
-            if (!sfuncs->is_empty(solution_stacks[SOLUTION_1]) || state->saved_spot != NO_SPOT) {
-                state->spot = SOLUTION_1;
-                break;
-            }
-        // moves 1 right if possible, otherwise trying more
-        case SOLUTION_1:
-            if (!sfuncs->is_empty(solution_stacks[SOLUTION_2]) || state->saved_spot != NO_SPOT) {
-                state->spot = SOLUTION_2;
-                break;
-            }
-        // moves 1 right if possible, otherwise trying more
-        case SOLUTION_2:
-            if (!sfuncs->is_empty(solution_stacks[SOLUTION_3]) || state->saved_spot != NO_SPOT) {
-                state->spot = SOLUTION_3;
-                break;
-            }
-        // moves 1 right if possible, otherwise not moving
-        case SOLUTION_3:
-            if (deck->num_cards_discard != 0) {
-                state->spot = DECK_STACK;
-                break;
-            }
-        case DECK_STACK:
-            break;
-        case WORKING_6:
-        case WORKING_5:
-        case WORKING_4:
-        case WORKING_3:
-        case WORKING_2:
-        case WORKING_1:
-        case WORKING_0:
-        {
-            do {
-                // move right until a stack with 1 or more is found, unless a selection has been made, in
-                // which case it will also move onto empty spots
-                state->spot = state->spot == WORKING_6 ? WORKING_0 : state->spot+1;
-            } while (state->saved_spot == NO_SPOT && sfuncs->is_empty(working_stacks[state->spot-WORKING_0]));
-            // gets the index of the stack landed upon
-            int stack_idx = state->spot-WORKING_0;
-            // gets the highest and lowest visible indexes in the stack
-            int highest_idx = sfuncs->highest_visible_index(working_stacks[stack_idx]);
-            int lowest_idx = sfuncs->lowest_visible_index(working_stacks[stack_idx]);
-            // if index is outside range of low-high, goes to the closest end
-            if (state->index < lowest_idx) {
-                state->index = lowest_idx;
-            } else if (state->index > highest_idx) {
-                state->index = highest_idx;
-            }
-            break;
-        }
-        default:
-            break;
-    }
+    /* draws with ncurses, building every card's picture once so drawing is just copying cells */
+    get_draw_functions()->set_backend(get_curses_backend());
 }
 // prints the state of the game at the bottom of the screen
 void print_state(GameState state) {
-    int max_y, max_x;
-    getmaxyx(stdscr, max_y, max_x);
+    int max_y = getmaxy(stdscr);
     char *spot;
     char *saved_spot;
     switch(state.spot) {
@@ -823,17 +459,139 @@ void print_state(GameState state) {
             saved_spot = "NO_SPOT";
             break;
     }
-    mvprintw(max_y-2, 0, "SPOT:      %15s, INDEX:       %d", spot, state.index, max_x);
-    mvprintw(max_y-1, 0, "SAVED SPOT:%15s, SAVED INDEX: %d", saved_spot, state.saved_index, max_x);
+    mvprintw(max_y-2, 0, "SPOT:      %15s, INDEX:       %d", spot, state.index);
+    mvprintw(max_y-1, 0, "SAVED SPOT:%15s, SAVED INDEX: %d", saved_spot, state.saved_index);
 }
 
-// returns whether or not the game is complete
-bool game_complete(Deck *deck, CardStack *solution_stacks, CardStack *working_stacks, GameState *state) {
-    return solution_stacks[SOLUTION_0].num_cards == 13
-        && solution_stacks[SOLUTION_1].num_cards == 13
-        && solution_stacks[SOLUTION_2].num_cards == 13
-        && solution_stacks[SOLUTION_3].num_cards == 13;
+// formats a duration in nanoseconds for the latency display
+static const char *format_ns(uint64_t ns, char *buffer, size_t size) {
+    if (ns < 1000) {
+        snprintf(buffer, size, "%" PRIu64 "ns", ns);
+    } else if (ns < 1000000) {
+        snprintf(buffer, size, "%.1fus", ns / 1e3);
+    } else {
+        snprintf(buffer, size, "%.1fms", ns / 1e6);
+    }
+    return buffer;
+}
+// draws the p50 and p99 times of the game loop on the bottom line of the screen
+void draw_latency_hud(const LoopLatency *latency, Screen *screen) {
+    const LatencyFunctions *lfuncs = get_latency_functions();
+    char line[160], b[6][16];
+    snprintf(line, sizeof(line), "key to paint p50 %s p99 %s | handle p50 %s p99 %s | render p50 %s p99 %s",
+             format_ns(lfuncs->percentile(&latency->total, 0.5), b[0], sizeof(b[0])),
+             format_ns(lfuncs->percentile(&latency->total, 0.99), b[1], sizeof(b[1])),
+             format_ns(lfuncs->percentile(&latency->handle, 0.5), b[2], sizeof(b[2])),
+             format_ns(lfuncs->percentile(&latency->handle, 0.99), b[3], sizeof(b[3])),
+             format_ns(lfuncs->percentile(&latency->render, 0.5), b[4], sizeof(b[4])),
+             format_ns(lfuncs->percentile(&latency->render, 0.99), b[5], sizeof(b[5])));
+    // stops short of the bottom right corner, which would scroll the screen
+    mvprintw(LINES-1, 0, "%-*.*s", COLS-1, COLS-1, line);
+    screen->cells_written += COLS-1;
+    screen->total_cells_written += COLS-1;
+}
+// writes the latency histograms of the game loop to a file. Returns false on failure.
+bool write_latency(const char *path, const LoopLatency *latency) {
+    const LatencyFunctions *lfuncs = get_latency_functions();
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        return false;
+    }
+    lfuncs->write_summary(file, "key to paint", &latency->total);
+    lfuncs->write_summary(file, "handle_keypress", &latency->handle);
+    lfuncs->write_summary(file, "game_complete", &latency->complete);
+    lfuncs->write_summary(file, "draw_screen", &latency->render);
+    return fclose(file) == 0;
+}
+// has the hint engine search the board if the position changed, taking down
+// the hint for the old one, and fills in the best move found so far while
+// the hint is up
+void update_hint(HintEngine *hints, const Board *board, GameState *state) {
+    const HintFunctions *hfuncs = get_hint_functions();
+    if (hfuncs->search(hints, board)) {
+        state->hint_up = false;
+    }
+    Move hint;
+    if (state->hint_up && hfuncs->hint(hints, &hint) == HINT_NONE) {
+        state->hint_up = false;
+    }
+    // the spots of the old hint are drawn again whether it moved or went away
+    if (state->hint_from != NO_SPOT) {
+        state->dirty |= SPOT_BIT(state->hint_from) | SPOT_BIT(state->hint_to);
+    }
+    if (!state->hint_up) {
+        state->hint_from = state->hint_to = NO_SPOT;
+        return;
+    }
+    if (hint.type == MOVE_FLIP) {
+        state->hint_from = state->hint_to = DECK_STACK;
+    } else {
+        state->hint_from = hint.from;
+        state->hint_to = hint.to;
+        state->hint_index = hint.index;
+    }
+    state->dirty |= SPOT_BIT(state->hint_from) | SPOT_BIT(state->hint_to);
+}
+// shows on the status line whether the position can still be won, as far as
+// the hint engine's search got. Returns whether that changed.
+bool update_winnable(HintEngine *hints, GameState *state) {
+    SOLVE_RESULT result;
+    WINNABLE_STATUS winnable = WINNABLE_SEARCHING;
+    if (get_hint_functions()->result(hints, &result)) {
+        winnable = result == SOLVE_WON ? WINNABLE_YES : result == SOLVE_LOST ? WINNABLE_NO : WINNABLE_UNKNOWN;
+    }
+    if (winnable == state->winnable) {
+        return false;
+    }
+    state->winnable = winnable;
+    state->dirty |= DIRTY_STATUS;
+    return true;
+}
+// waits for a key. While the search of whether the position can still be won
+// is running, wakes up every WINNABLE_POLL_MS to check on it, and returns ERR
+// once its answer is in so it can be drawn.
+int wait_for_key(HintEngine *hints, GameState *state) {
+    while (true) {
+        bool searching = state->winnable == WINNABLE_SEARCHING;
+        timeout(searching ? WINNABLE_POLL_MS : -1);
+        int c = getch();
+        if (c != ERR || !searching || update_winnable(hints, state)) {
+            return c;
+        }
+    }
 }
+// puts the cards away one at a time once every card is face up and the deck
+// is used up, drawing a frame for each at "fps" frames per second. With an
+// fps of 0 they are put away at once. Returns whether any card was moved.
+bool animate_auto_complete(Board *board, Journal *journal, GameState *state, Screen *screen, unsigned int fps) {
+    bool moved = false;
+    while (get_control_functions()->auto_complete(board, journal, state)) {
+        moved = true;
+        if (fps) {
+            get_draw_functions()->screen(board, state, screen);
+            refresh();
+            napms(1000 / fps);
+        }
+    }
+    return moved;
+}
+// writes the moves played, leaving out any taken back, as a replay file.
+// Returns false on failure.
+bool write_replay(const char *path, uint64_t deal_number, const Journal *journal) {
+    const ReplayFunctions *rfuncs = get_replay_functions();
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        return false;
+    }
+    ReplayWriter writer;
+    bool ok = rfuncs->open_writer(&writer, file, deal_number, REPLAY_DEFAULT_INTERVAL);
+    for (unsigned int i = 0; i < journal->position && ok; i++) {
+        ok = rfuncs->record(&writer, get_journal_functions()->entry_move(&writer.board, journal->entries[i]));
+    }
+    ok = rfuncs->close_writer(&writer) && ok;
+    return fclose(file) == 0 && ok;
+}
+
 void draw_win_splashscreen() {
     mvprintw(3, 6, "╔════════════════════════════════════╗");
     mvprintw(4, 6, "║                                    ║");
@@ -841,31 +599,3 @@ void draw_win_splashscreen() {
     mvprintw(6, 6, "║                                    ║");
     mvprintw(7, 6, "╚════════════════════════════════════╝");
 }
-void draw_help_menu() {
-    mvprintw( 1, 2, "╔══════════════════════════════════════════════════╗");
-    mvprintw( 2, 2, "║                                     x: exit help ║");
-    mvprintw( 3, 2, "║ Controls:                                        ║");
-    mvprintw( 4, 2, "║ ──────────────────────────────────────────────── ║");
-    mvprintw( 5, 2, "║ w:      up                                       ║");
-    mvprintw( 6, 2, "║ a:      left                                     ║");
-    mvprintw( 7, 2, "║ s:      down                                     ║");
-    mvprintw( 8, 2, "║ d:      right                                    ║");
-    mvprintw( 9, 2, "║ f:      flip from deck to discard                ║");
-    mvprintw(10, 2, "║ space:  select                                   ║");
-    mvprintw(11, 2, "║ c:      cancel selection                         ║");
-    mvprintw(12, 2, "║ q:      quit game                                ║");
-    mvprintw(13, 2, "║                                                  ║");
-    mvprintw(14, 2, "║ Indicators:                                      ║");
-    mvprintw(15, 2, "║ ──────────────────────────────────────────────── ║");
-    mvprintw(16, 2, "║ yellow border:      selected                     ║");
-    mvprintw(17, 2, "║ green border:       current position             ║");
-    mvprintw(18, 2, "║ x on card:          empty spot                   ║");
-    mvprintw(19, 2, "║ 4 symbols on card:  card present but not visible ║");
-    mvprintw(20, 2, "║ ──────────────────────────────────────────────── ║");
-    mvprintw(21, 2, "║                                                  ║");
-    mvprintw(22, 2, "║ Author: Elliot Wasem        Github: elliot-wasem ║");
-    mvprintw(23, 2, "╚══════════════════════════════════════════════════╝");
-
-
-
-}
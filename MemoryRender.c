@@ -0,0 +1,153 @@
+#include "Render.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <wchar.h>
+
+void memory_erase(void);
+void memory_text(int y, int x, const char *text);
+void memory_load_glyph(unsigned int id, const Glyph *);
+void memory_glyph(unsigned int id, int y, int x);
+int memory_lines(void);
+int memory_cols(void);
+bool memory_init(int lines, int cols);
+void memory_free(void);
+const Cell *memory_cells(void);
+void memory_write(FILE *, bool colors);
+
+const RenderBackend memory_backend = {
+    .erase=memory_erase,
+    .text=memory_text,
+    .load_glyph=memory_load_glyph,
+    .glyph=memory_glyph,
+    .lines=memory_lines,
+    .cols=memory_cols
+};
+
+const MemoryRenderFunctions memory_render_functions = {
+    .backend=&memory_backend,
+    .init=memory_init,
+    .free=memory_free,
+    .cells=memory_cells,
+    .write=memory_write
+};
+
+// the grid of cells drawn into, row by row, and the glyphs loaded into it
+static Cell *grid = NULL;
+static int grid_lines = 0, grid_cols = 0;
+static Glyph glyphs[MAX_GLYPHS];
+
+// returns pointer to the handler for the in-memory backend
+const MemoryRenderFunctions *get_memory_render_functions() {
+    return &memory_render_functions;
+}
+
+// allocates a blank grid of the given size. Returns false on failure.
+bool memory_init(int lines, int cols) {
+    memory_free();
+    grid = malloc(sizeof(Cell) * lines * cols);
+    if (grid == NULL) {
+        return false;
+    }
+    grid_lines = lines;
+    grid_cols = cols;
+    memory_erase();
+    return true;
+}
+// frees the grid
+void memory_free(void) {
+    free(grid);
+    grid = NULL;
+    grid_lines = grid_cols = 0;
+}
+// returns the grid, "lines" rows of "cols" cells
+const Cell *memory_cells(void) {
+    return grid;
+}
+
+// sets one cell, ignoring cells outside the grid
+static void set_cell(int y, int x, Cell cell) {
+    if (y >= 0 && y < grid_lines && x >= 0 && x < grid_cols) {
+        grid[y*grid_cols + x] = cell;
+    }
+}
+// decodes the next character of UTF-8 text, moving past it. Bytes that are
+// not valid UTF-8 come out as '?'.
+static wchar_t next_char(const unsigned char **text) {
+    const unsigned char *s = *text;
+    unsigned int length = s[0] < 0x80 ? 1 : (s[0] & 0xe0) == 0xc0 ? 2 : (s[0] & 0xf0) == 0xe0 ? 3 : (s[0] & 0xf8) == 0xf0 ? 4 : 0;
+    wchar_t ch = length == 1 ? s[0] : s[0] & (0x7f >> length);
+    for (unsigned int i = 1; i < length; i++) {
+        if ((s[i] & 0xc0) != 0x80) {
+            length = 0;
+            break;
+        }
+        ch = ch << 6 | (s[i] & 0x3f);
+    }
+    *text += length ? length : 1;
+    return length ? ch : L'?';
+}
+
+// blanks every cell
+void memory_erase(void) {
+    for (int i = 0; i < grid_lines * grid_cols; i++) {
+        grid[i] = (Cell){ L' ', 0 };
+    }
+}
+// writes UTF-8 text in the default color
+void memory_text(int y, int x, const char *text) {
+    const unsigned char *s = (const unsigned char *)text;
+    while (*s) {
+        set_cell(y, x++, (Cell){ next_char(&s), 0 });
+    }
+}
+// keeps a copy of a glyph
+void memory_load_glyph(unsigned int id, const Glyph *glyph) {
+    glyphs[id] = *glyph;
+}
+// copies a glyph into the grid
+void memory_glyph(unsigned int id, int y, int x) {
+    for (int row = 0; row < CARD_HEIGHT; row++) {
+        for (int col = 0; col < CARD_WIDTH; col++) {
+            set_cell(y+row, x+col, glyphs[id].cells[row][col]);
+        }
+    }
+}
+// returns the height of the grid
+int memory_lines(void) {
+    return grid_lines;
+}
+// returns the width of the grid
+int memory_cols(void) {
+    return grid_cols;
+}
+
+// writes a UTF-8 character
+static void write_char(FILE *file, wchar_t ch) {
+    if (ch < 0x80) {
+        fputc(ch, file);
+    } else if (ch < 0x800) {
+        fprintf(file, "%c%c", 0xc0 | ch >> 6, 0x80 | (ch & 0x3f));
+    } else if (ch < 0x10000) {
+        fprintf(file, "%c%c%c", 0xe0 | ch >> 12, 0x80 | (ch >> 6 & 0x3f), 0x80 | (ch & 0x3f));
+    } else {
+        fprintf(file, "%c%c%c%c", 0xf0 | ch >> 18, 0x80 | (ch >> 12 & 0x3f), 0x80 | (ch >> 6 & 0x3f), 0x80 | (ch & 0x3f));
+    }
+}
+// writes the grid as text: each row as UTF-8 characters, followed by the same
+// row of color pair numbers if "colors" is set, so two frames can be compared with diff
+void memory_write(FILE *file, bool colors) {
+    for (int y = 0; y < grid_lines; y++) {
+        for (int x = 0; x < grid_cols; x++) {
+            write_char(file, grid[y*grid_cols + x].ch);
+        }
+        fputc('\n', file);
+        if (!colors) {
+            continue;
+        }
+        for (int x = 0; x < grid_cols; x++) {
+            fputc('0' + grid[y*grid_cols + x].color, file);
+        }
+        fputc('\n', file);
+    }
+}
@@ -0,0 +1,162 @@
+#include "MoveGen.h"
+#include "Board.h"
+#include "Card.h"
+#include "Packed.h"
+#include <stdint.h>
+
+unsigned int generate_moves(const PackedBoard *, Move *moves);
+uint64_t stackable_on(PackedCard);
+
+const MoveGenFunctions move_gen_functions = {
+    .generate=generate_moves,
+    .stackable_on=stackable_on
+};
+
+// returns pointer to the handler for move generator functions
+const MoveGenFunctions *get_move_gen_functions() {
+    return &move_gen_functions;
+}
+
+// bit for a card identity in a 52 bit card set
+#define CARD_BIT(id) (1ULL << (id))
+// the set of cards that can go on top of card "id" on a working stack: one
+// value lower, in either suit of the other color. Red suits are odd.
+#define STACK_MASK(id) ((id) % NUM_VALUES == VALUE_ACE ? 0 :      \
+    (id) / NUM_VALUES % 2 == 0                                    \
+        ? CARD_BIT(DIAMOND*NUM_VALUES + (id) % NUM_VALUES - 1)    \
+        | CARD_BIT(HEART*NUM_VALUES + (id) % NUM_VALUES - 1)      \
+        : CARD_BIT(SPADE*NUM_VALUES + (id) % NUM_VALUES - 1)      \
+        | CARD_BIT(CLUB*NUM_VALUES + (id) % NUM_VALUES - 1))
+#define STACK_MASK_SUIT(s) \
+    STACK_MASK((s)+0), STACK_MASK((s)+1), STACK_MASK((s)+2), STACK_MASK((s)+3),   \
+    STACK_MASK((s)+4), STACK_MASK((s)+5), STACK_MASK((s)+6), STACK_MASK((s)+7),   \
+    STACK_MASK((s)+8), STACK_MASK((s)+9), STACK_MASK((s)+10), STACK_MASK((s)+11), \
+    STACK_MASK((s)+12)
+
+// can-stack-on sets for every card, worked out at compile time
+static const uint64_t STACK_MASKS[NUM_CARDS] = {
+    STACK_MASK_SUIT(SPADE*NUM_VALUES),
+    STACK_MASK_SUIT(DIAMOND*NUM_VALUES),
+    STACK_MASK_SUIT(CLUB*NUM_VALUES),
+    STACK_MASK_SUIT(HEART*NUM_VALUES)
+};
+
+// the four kings, the only cards that can start an empty working stack
+static const uint64_t KING_MASK =
+    CARD_BIT(SPADE*NUM_VALUES + VALUE_KING) | CARD_BIT(DIAMOND*NUM_VALUES + VALUE_KING)
+    | CARD_BIT(CLUB*NUM_VALUES + VALUE_KING) | CARD_BIT(HEART*NUM_VALUES + VALUE_KING);
+
+// returns the set of cards that can go on top of the given card on a working stack
+uint64_t stackable_on(PackedCard card) {
+    return STACK_MASKS[card & PACKED_ID_MASK];
+}
+
+// fills "moves" with every legal move from the position and returns how many
+// there are. "moves" must have room for MAX_MOVES.
+unsigned int generate_moves(const PackedBoard *packed, Move *moves) {
+    unsigned int num_moves = 0;
+
+    // where each working stack starts, and the set of cards each one accepts
+    unsigned int start[NUM_WORKING_STACKS];
+    uint64_t accepts[NUM_WORKING_STACKS];
+    uint64_t any_accepts = 0;
+    unsigned int discard_start = packed->num_cards[PACKED_DECK];
+    unsigned int offset = discard_start + packed->num_cards[PACKED_DISCARD];
+    for (int i = 0; i < NUM_WORKING_STACKS; i++) {
+        unsigned int n = packed->num_cards[PACKED_WORKING_0+i];
+        start[i] = offset;
+        accepts[i] = n ? STACK_MASKS[packed->cards[offset+n-1] & PACKED_ID_MASK] : KING_MASK;
+        any_accepts |= accepts[i];
+        offset += n;
+    }
+
+    // the set of cards the solution stacks accept, and which stack holds each suit
+    uint64_t solution_accepts = 0;
+    int suit_stack[NUM_SUITS];
+    for (int i = 0; i < NUM_SOLUTION_STACKS; i++) {
+        unsigned int count = packed->solution[i] & PACKED_SOLUTION_COUNT_MASK;
+        unsigned int suit = packed->solution[i] >> PACKED_SOLUTION_SUIT_SHIFT;
+        if (count == 0) {
+            continue;
+        }
+        suit_stack[suit] = i;
+        if (count < NUM_VALUES) {
+            solution_accepts |= CARD_BIT(suit*NUM_VALUES + count);
+        }
+    }
+
+    // working and discard to solution
+    for (int i = 0; i <= NUM_WORKING_STACKS; i++) {
+        unsigned int n, index;
+        SELECTED_SPOT from;
+        if (i < NUM_WORKING_STACKS) {
+            n = packed->num_cards[PACKED_WORKING_0+i];
+            index = start[i]+n-1;
+            from = WORKING_0+i;
+        } else {
+            n = packed->num_cards[PACKED_DISCARD];
+            index = discard_start+n-1;
+            from = DECK_STACK;
+        }
+        if (n == 0) {
+            continue;
+        }
+        unsigned int id = packed->cards[index] & PACKED_ID_MASK;
+        if (id % NUM_VALUES == VALUE_ACE) {
+            // aces can start any empty solution stack
+            for (int s = 0; s < NUM_SOLUTION_STACKS; s++) {
+                if ((packed->solution[s] & PACKED_SOLUTION_COUNT_MASK) == 0) {
+                    moves[num_moves++] = (Move){ MOVE_CARDS, from, SOLUTION_0+s, from == DECK_STACK ? 0 : n-1 };
+                }
+            }
+        } else if (solution_accepts & CARD_BIT(id)) {
+            moves[num_moves++] = (Move){ MOVE_CARDS, from, SOLUTION_0+suit_stack[id / NUM_VALUES], from == DECK_STACK ? 0 : n-1 };
+        }
+    }
+
+    // discard to working
+    if (packed->num_cards[PACKED_DISCARD]) {
+        uint64_t bit = CARD_BIT(packed->cards[discard_start + packed->num_cards[PACKED_DISCARD] - 1] & PACKED_ID_MASK);
+        for (int i = 0; i < NUM_WORKING_STACKS; i++) {
+            if (accepts[i] & bit) {
+                moves[num_moves++] = (Move){ MOVE_CARDS, DECK_STACK, WORKING_0+i, 0 };
+            }
+        }
+    }
+
+    // working to working, moving any face up card along with the cards above it
+    for (int i = 0; i < NUM_WORKING_STACKS; i++) {
+        unsigned int n = packed->num_cards[PACKED_WORKING_0+i];
+        const PackedCard *cards = &packed->cards[start[i]];
+        for (unsigned int index = n; index-- > 0 && (cards[index] & PACKED_VISIBLE);) {
+            uint64_t bit = CARD_BIT(cards[index] & PACKED_ID_MASK);
+            if (!(any_accepts & bit)) {
+                continue;
+            }
+            for (int j = 0; j < NUM_WORKING_STACKS; j++) {
+                if (j != i && (accepts[j] & bit)) {
+                    moves[num_moves++] = (Move){ MOVE_CARDS, WORKING_0+i, WORKING_0+j, index };
+                }
+            }
+        }
+    }
+
+    // solution to working
+    for (int s = 0; s < NUM_SOLUTION_STACKS; s++) {
+        unsigned int count = packed->solution[s] & PACKED_SOLUTION_COUNT_MASK;
+        if (count == 0) {
+            continue;
+        }
+        uint64_t bit = CARD_BIT((packed->solution[s] >> PACKED_SOLUTION_SUIT_SHIFT) * NUM_VALUES + count - 1);
+        for (int j = 0; j < NUM_WORKING_STACKS; j++) {
+            if (accepts[j] & bit) {
+                moves[num_moves++] = (Move){ MOVE_CARDS, SOLUTION_0+s, WORKING_0+j, 0 };
+            }
+        }
+    }
+
+    if (packed->num_cards[PACKED_DECK] || (packed->num_cards[PACKED_DISCARD] && PACKED_CAN_RECYCLE(packed))) {
+        moves[num_moves++] = (Move){ .type=MOVE_FLIP };
+    }
+    return num_moves;
+}
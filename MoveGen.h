@@ -0,0 +1,20 @@
+#ifndef __MOVE_GEN_H__
+#define __MOVE_GEN_H__
+#include <stdint.h>
+#include "Board.h"
+#include "Packed.h"
+
+// upper bound on the number of legal moves from any position: 42 working to
+// working, 28 solution to working, 7 working to solution, 8 from the discard
+// pile and the flip
+#define MAX_MOVES 96
+
+// handler struct for the move generator
+typedef struct {
+    unsigned int (*generate)(const PackedBoard *, Move *moves);
+    uint64_t (*stackable_on)(PackedCard);
+} MoveGenFunctions;
+
+const MoveGenFunctions *get_move_gen_functions();
+
+#endif /* __MOVE_GEN_H__ */
@@ -0,0 +1,455 @@
+#include "Packed.h"
+#include "Board.h"
+#include "Card.h"
+#include "Deck.h"
+#include "Zobrist.h"
+#include <string.h>
+
+PackedCard pack_card(Card);
+Card unpack_card(PackedCard);
+unsigned int pack_stack(const CardStack *, PackedCard *);
+CardStack unpack_stack(const PackedCard *, unsigned int num_cards);
+PackedBoard pack(const Board *);
+Board unpack(const PackedBoard *);
+bool packed_is_legal(const PackedBoard *, Move);
+bool packed_apply_move(PackedBoard *, Move);
+bool packed_is_won(const PackedBoard *);
+bool packed_is_safe_for_solution(const PackedBoard *, PackedCard);
+bool packed_safe_solution_move(const PackedBoard *, Move *);
+PackedBoard canonicalize(const PackedBoard *);
+bool packed_is_valid(const PackedBoard *);
+
+const PackedFunctions packed_functions = {
+    .pack_card=pack_card,
+    .unpack_card=unpack_card,
+    .pack_stack=pack_stack,
+    .unpack_stack=unpack_stack,
+    .pack=pack,
+    .unpack=unpack,
+    .is_legal=packed_is_legal,
+    .apply_move=packed_apply_move,
+    .is_won=packed_is_won,
+    .is_safe_for_solution=packed_is_safe_for_solution,
+    .canonicalize=canonicalize,
+    .is_valid=packed_is_valid,
+    .safe_solution_move=packed_safe_solution_move
+};
+
+// returns pointer to the handler for packed board functions
+const PackedFunctions *get_packed_functions() {
+    return &packed_functions;
+}
+
+// packs a card into a single byte
+PackedCard pack_card(Card card) {
+    return (card.suit * NUM_VALUES + card.value) | (card.is_visible ? PACKED_VISIBLE : 0);
+}
+// unpacks a card from a single byte
+Card unpack_card(PackedCard packed) {
+    unsigned int id = packed & PACKED_ID_MASK;
+    return (Card){
+        .suit=id / NUM_VALUES,
+        .value=id % NUM_VALUES,
+        .is_visible=(packed & PACKED_VISIBLE) != 0
+    };
+}
+// packs the cards of a stack into "out", returning how many were written
+unsigned int pack_stack(const CardStack *stack, PackedCard *out) {
+    for (unsigned int i = 0; i < stack->num_cards; i++) {
+        out[i] = pack_card(stack->cards[i]);
+    }
+    return stack->num_cards;
+}
+// unpacks "num_cards" packed cards into a stack
+CardStack unpack_stack(const PackedCard *cards, unsigned int num_cards) {
+    CardStack stack = { .num_cards=num_cards };
+    for (unsigned int i = 0; i < num_cards; i++) {
+        stack.cards[i] = unpack_card(cards[i]);
+    }
+    stack.hash = get_zobrist_functions()->stack_hash(&stack);
+    return stack;
+}
+
+// packs a whole board
+PackedBoard pack(const Board *board) {
+    PackedBoard packed = { .num_cards={ 0 } };
+    unsigned int n = 0;
+    for (unsigned int i = 0; i < board->deck.num_cards; i++) {
+        packed.cards[n++] = pack_card(board->deck.cards[i]);
+    }
+    packed.num_cards[PACKED_DECK] = board->deck.num_cards;
+    for (unsigned int i = 0; i < board->deck.num_cards_discard; i++) {
+        packed.cards[n++] = pack_card(board->deck.discard[i]);
+    }
+    packed.num_cards[PACKED_DISCARD] = board->deck.num_cards_discard;
+    for (int i = 0; i < NUM_WORKING_STACKS; i++) {
+        packed.num_cards[PACKED_WORKING_0+i] = pack_stack(&board->working_stacks[i], &packed.cards[n]);
+        n += board->working_stacks[i].num_cards;
+    }
+    for (int i = 0; i < NUM_SOLUTION_STACKS; i++) {
+        const CardStack *stack = &board->solution_stacks[i];
+        packed.solution[i] = stack->num_cards
+            ? stack->num_cards | stack->cards[0].suit << PACKED_SOLUTION_SUIT_SHIFT
+            : 0;
+    }
+#if PASS_LIMIT
+    packed.passes = board->deck.passes;
+#endif
+    return packed;
+}
+// unpacks a whole board
+Board unpack(const PackedBoard *packed) {
+    Board board;
+    unsigned int n = 0;
+    board.deck.num_cards = packed->num_cards[PACKED_DECK];
+    for (unsigned int i = 0; i < board.deck.num_cards; i++) {
+        board.deck.cards[i] = unpack_card(packed->cards[n++]);
+    }
+    board.deck.num_cards_discard = packed->num_cards[PACKED_DISCARD];
+#if PASS_LIMIT
+    board.deck.passes = packed->passes;
+#else
+    board.deck.passes = 0;
+#endif
+    for (unsigned int i = 0; i < board.deck.num_cards_discard; i++) {
+        board.deck.discard[i] = unpack_card(packed->cards[n++]);
+    }
+    for (int i = 0; i < NUM_WORKING_STACKS; i++) {
+        board.working_stacks[i] = unpack_stack(&packed->cards[n], packed->num_cards[PACKED_WORKING_0+i]);
+        n += packed->num_cards[PACKED_WORKING_0+i];
+    }
+    for (int i = 0; i < NUM_SOLUTION_STACKS; i++) {
+        unsigned int count = packed->solution[i] & PACKED_SOLUTION_COUNT_MASK;
+        SUIT suit = packed->solution[i] >> PACKED_SOLUTION_SUIT_SHIFT;
+        board.solution_stacks[i].num_cards = count;
+        for (unsigned int j = 0; j < count; j++) {
+            board.solution_stacks[i].cards[j] = (Card){ .suit=suit, .value=j, .is_visible=true };
+        }
+        board.solution_stacks[i].hash = get_zobrist_functions()->stack_hash(&board.solution_stacks[i]);
+    }
+    board.deck.hash = get_zobrist_functions()->deck_hash(&board.deck);
+    return board;
+}
+
+// returns the index of the first card of a segment
+static unsigned int segment_start(const PackedBoard *packed, int segment) {
+    unsigned int start = 0;
+    for (int i = 0; i < segment; i++) {
+        start += packed->num_cards[i];
+    }
+    return start;
+}
+// returns the number of cards not on a solution stack
+static unsigned int total_cards(const PackedBoard *packed) {
+    return segment_start(packed, NUM_PACKED_SEGMENTS);
+}
+// returns the segment a spot reads its cards from, or -1 for solution stacks
+static int spot_segment(SELECTED_SPOT spot) {
+    if (spot == DECK_STACK) {
+        return PACKED_DISCARD;
+    }
+    if (spot >= WORKING_0 && spot <= WORKING_6) {
+        return PACKED_WORKING_0 + spot - WORKING_0;
+    }
+    return -1;
+}
+// returns whether or not the spot is one of the solution stacks
+static bool is_solution_spot(SELECTED_SPOT spot) {
+    return spot >= SOLUTION_0 && spot <= SOLUTION_3;
+}
+// removes the top "count" cards of a segment, copying them into "out". Unused
+// bytes are kept zeroed so equal positions are equal byte for byte.
+static void remove_cards(PackedBoard *packed, int segment, unsigned int count, PackedCard *out) {
+    unsigned int end = segment_start(packed, segment) + packed->num_cards[segment];
+    unsigned int total = total_cards(packed);
+    memcpy(out, &packed->cards[end-count], count);
+    memmove(&packed->cards[end-count], &packed->cards[end], total - end);
+    memset(&packed->cards[total-count], 0, count);
+    packed->num_cards[segment] -= count;
+}
+// adds "count" cards to the top of a segment
+static void add_cards(PackedBoard *packed, int segment, const PackedCard *cards, unsigned int count) {
+    unsigned int end = segment_start(packed, segment) + packed->num_cards[segment];
+    memmove(&packed->cards[end+count], &packed->cards[end], total_cards(packed) - end);
+    memcpy(&packed->cards[end], cards, count);
+    packed->num_cards[segment] += count;
+}
+// returns the top card of a solution stack, which must not be empty
+static PackedCard solution_top(const PackedBoard *packed, int stack) {
+    unsigned int count = packed->solution[stack] & PACKED_SOLUTION_COUNT_MASK;
+    unsigned int suit = packed->solution[stack] >> PACKED_SOLUTION_SUIT_SHIFT;
+    return (suit * NUM_VALUES + count - 1) | PACKED_VISIBLE;
+}
+
+// finds the lowest card the move would pick up and how many cards go with it.
+// Returns false if there is nothing there that can be picked up.
+static bool source_cards(const PackedBoard *packed, Move move, PackedCard *card, unsigned int *count) {
+    if (is_solution_spot(move.from)) {
+        if ((packed->solution[move.from-SOLUTION_0] & PACKED_SOLUTION_COUNT_MASK) == 0) {
+            return false;
+        }
+        *card = solution_top(packed, move.from-SOLUTION_0);
+        *count = 1;
+        return true;
+    }
+    int segment = spot_segment(move.from);
+    if (segment < 0 || packed->num_cards[segment] == 0) {
+        return false;
+    }
+    const PackedCard *cards = &packed->cards[segment_start(packed, segment)];
+    unsigned int index = move.from == DECK_STACK ? packed->num_cards[segment]-1 : move.index;
+    if (index >= packed->num_cards[segment] || !(cards[index] & PACKED_VISIBLE)) {
+        return false;
+    }
+    *card = cards[index];
+    *count = packed->num_cards[segment] - index;
+    return true;
+}
+
+// returns whether or not the move is allowed on the given packed board
+bool packed_is_legal(const PackedBoard *packed, Move move) {
+    if (move.type == MOVE_FLIP) {
+        return packed->num_cards[PACKED_DECK] || (packed->num_cards[PACKED_DISCARD] && PACKED_CAN_RECYCLE(packed));
+    }
+
+    PackedCard card;
+    unsigned int count;
+    if (move.from == move.to || !source_cards(packed, move, &card, &count)) {
+        return false;
+    }
+    unsigned int id = card & PACKED_ID_MASK;
+
+    if (is_solution_spot(move.to)) {
+        // only single cards go onto solution stacks, and never from another one
+        if (is_solution_spot(move.from) || count != 1) {
+            return false;
+        }
+        uint8_t solution = packed->solution[move.to-SOLUTION_0];
+        unsigned int to_count = solution & PACKED_SOLUTION_COUNT_MASK;
+        if (to_count == 0) {
+            return id % NUM_VALUES == VALUE_ACE;
+        }
+        return id / NUM_VALUES == solution >> PACKED_SOLUTION_SUIT_SHIFT && id % NUM_VALUES == to_count;
+    }
+
+    int to_segment = spot_segment(move.to);
+    if (to_segment < PACKED_WORKING_0) {
+        return false;
+    }
+    if (packed->num_cards[to_segment] == 0) {
+        return id % NUM_VALUES == VALUE_KING;
+    }
+    unsigned int top = packed->cards[segment_start(packed, to_segment) + packed->num_cards[to_segment] - 1] & PACKED_ID_MASK;
+    // red suits are odd, black suits are even
+    return id % NUM_VALUES + 1 == top % NUM_VALUES && (id / NUM_VALUES & 1) != (top / NUM_VALUES & 1);
+}
+
+// applies the move to the packed board if it is legal. Returns whether or not it was applied.
+bool packed_apply_move(PackedBoard *packed, Move move) {
+    if (!packed_is_legal(packed, move)) {
+        return false;
+    }
+
+    if (move.type == MOVE_FLIP) {
+        uint8_t *num_cards = packed->num_cards;
+        if (num_cards[PACKED_DECK] == 0) {
+            // recycle the discard pile into the deck, which reverses it
+            for (unsigned int i = 0, j = num_cards[PACKED_DISCARD]-1; i < j; i++, j--) {
+                PackedCard temp = packed->cards[i];
+                packed->cards[i] = packed->cards[j];
+                packed->cards[j] = temp;
+            }
+            num_cards[PACKED_DECK] = num_cards[PACKED_DISCARD];
+            num_cards[PACKED_DISCARD] = 0;
+#if PASS_LIMIT
+            packed->passes++;
+#endif
+        }
+        // the deck and discard pile are adjacent, so the top of the deck
+        // moves past the discard pile to become its top
+        for (unsigned int i = 0; i < DRAW_COUNT && num_cards[PACKED_DECK]; i++) {
+            unsigned int top = num_cards[PACKED_DECK]-1;
+            PackedCard card = packed->cards[top];
+            memmove(&packed->cards[top], &packed->cards[top+1], num_cards[PACKED_DISCARD]);
+            packed->cards[top+num_cards[PACKED_DISCARD]] = card;
+            num_cards[PACKED_DECK]--;
+            num_cards[PACKED_DISCARD]++;
+        }
+        return true;
+    }
+
+    PackedCard cards[MAX_CARDS_IN_STACK];
+    unsigned int count;
+    if (is_solution_spot(move.from)) {
+        cards[0] = solution_top(packed, move.from-SOLUTION_0);
+        count = 1;
+        packed->solution[move.from-SOLUTION_0]--;
+        if ((packed->solution[move.from-SOLUTION_0] & PACKED_SOLUTION_COUNT_MASK) == 0) {
+            packed->solution[move.from-SOLUTION_0] = 0;
+        }
+    } else {
+        int segment = spot_segment(move.from);
+        count = move.from == DECK_STACK ? 1 : packed->num_cards[segment] - move.index;
+        remove_cards(packed, segment, count, cards);
+        cards[0] |= PACKED_VISIBLE;
+        // turn over the card that was under the moved ones
+        if (segment >= PACKED_WORKING_0 && packed->num_cards[segment] > 0) {
+            packed->cards[segment_start(packed, segment) + packed->num_cards[segment] - 1] |= PACKED_VISIBLE;
+        }
+    }
+
+    if (is_solution_spot(move.to)) {
+        unsigned int id = cards[0] & PACKED_ID_MASK;
+        packed->solution[move.to-SOLUTION_0] = (id % NUM_VALUES + 1) | (id / NUM_VALUES) << PACKED_SOLUTION_SUIT_SHIFT;
+    } else {
+        add_cards(packed, spot_segment(move.to), cards, count);
+    }
+    return true;
+}
+
+// returns whether or not every card has made it to the solution stacks
+bool packed_is_won(const PackedBoard *packed) {
+    for (int i = 0; i < NUM_SOLUTION_STACKS; i++) {
+        if ((packed->solution[i] & PACKED_SOLUTION_COUNT_MASK) != NUM_VALUES) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// returns whether or not a card can go to a solution stack without ever
+// being needed to hold another card: aces and twos, or cards whose two
+// lower cards of the other color are already on solution stacks
+bool packed_is_safe_for_solution(const PackedBoard *packed, PackedCard card) {
+    unsigned int id = card & PACKED_ID_MASK;
+    unsigned int value = id % NUM_VALUES;
+    unsigned int color = id / NUM_VALUES & 1;
+    if (value <= VALUE_2) {
+        return true;
+    }
+    unsigned int lower = 0;
+    for (int i = 0; i < NUM_SOLUTION_STACKS; i++) {
+        unsigned int count = packed->solution[i] & PACKED_SOLUTION_COUNT_MASK;
+        unsigned int suit = packed->solution[i] >> PACKED_SOLUTION_SUIT_SHIFT;
+        if (count >= value && (suit & 1) != color) {
+            lower++;
+        }
+    }
+    return lower == 2;
+}
+
+// finds a move of a card from the top of the discard pile or a working stack
+// to a solution stack that can never hurt. Aces go to the first empty
+// solution stack. Returns false if there is none.
+bool packed_safe_solution_move(const PackedBoard *packed, Move *move) {
+    for (SELECTED_SPOT from = WORKING_0; from <= DECK_STACK; from++) {
+        int segment = spot_segment(from);
+        if (packed->num_cards[segment] == 0) {
+            continue;
+        }
+        unsigned int index = from == DECK_STACK ? 0 : packed->num_cards[segment]-1;
+        PackedCard card = packed->cards[segment_start(packed, segment) + packed->num_cards[segment] - 1];
+        if (!packed_is_safe_for_solution(packed, card)) {
+            continue;
+        }
+        for (int i = 0; i < NUM_SOLUTION_STACKS; i++) {
+            *move = (Move){ MOVE_CARDS, from, SOLUTION_0+i, index };
+            if (packed_is_legal(packed, *move)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// returns the key working stacks are sorted by in a canonical board: the
+// card at the bottom, which no other stack can have, with empty stacks last
+static unsigned int canonical_key(const PackedBoard *packed, int stack, unsigned int start) {
+    return packed->num_cards[PACKED_WORKING_0+stack] ? packed->cards[start] & PACKED_ID_MASK : NUM_CARDS;
+}
+// gives the one board that stands for every board the same as this one but
+// for the order of the working stacks and which solution stack holds which
+// suit, as neither changes what can be played. The working stacks are
+// sorted by the card at the bottom, and each solution stack goes to the slot
+// of its suit.
+PackedBoard canonicalize(const PackedBoard *packed) {
+    PackedBoard canonical = *packed;
+    unsigned int start[NUM_WORKING_STACKS];
+    int order[NUM_WORKING_STACKS];
+    unsigned int n = packed->num_cards[PACKED_DECK] + packed->num_cards[PACKED_DISCARD];
+    for (int i = 0; i < NUM_WORKING_STACKS; i++) {
+        start[i] = n;
+        n += packed->num_cards[PACKED_WORKING_0+i];
+    }
+    // insertion sort, as there are only seven
+    for (int i = 0; i < NUM_WORKING_STACKS; i++) {
+        int j = i;
+        for (; j > 0 && canonical_key(packed, order[j-1], start[order[j-1]]) > canonical_key(packed, i, start[i]); j--) {
+            order[j] = order[j-1];
+        }
+        order[j] = i;
+    }
+    n = packed->num_cards[PACKED_DECK] + packed->num_cards[PACKED_DISCARD];
+    for (int i = 0; i < NUM_WORKING_STACKS; i++) {
+        unsigned int count = packed->num_cards[PACKED_WORKING_0+order[i]];
+        memcpy(&canonical.cards[n], &packed->cards[start[order[i]]], count);
+        canonical.num_cards[PACKED_WORKING_0+i] = count;
+        n += count;
+    }
+
+    memset(canonical.solution, 0, sizeof(canonical.solution));
+    for (int i = 0; i < NUM_SOLUTION_STACKS; i++) {
+        if (packed->solution[i]) {
+            canonical.solution[packed->solution[i] >> PACKED_SOLUTION_SUIT_SHIFT] = packed->solution[i];
+        }
+    }
+    return canonical;
+}
+
+// returns whether or not a packed board read from outside, such as a file,
+// is a position that could be unpacked and played: every segment fits the
+// stack it unpacks into, and the segments and solution stacks hold each of
+// the 52 cards exactly once
+bool packed_is_valid(const PackedBoard *packed) {
+    bool seen[NUM_CARDS] = { false };
+    unsigned int num_cards = 0;
+    unsigned int total_solved = 0;
+    for (int segment = 0; segment < NUM_PACKED_SEGMENTS; segment++) {
+        unsigned int capacity = segment < PACKED_WORKING_0 ? NUM_CARDS : MAX_CARDS_IN_STACK;
+        if (packed->num_cards[segment] > capacity) {
+            return false;
+        }
+        num_cards += packed->num_cards[segment];
+    }
+    for (int i = 0; i < NUM_SOLUTION_STACKS; i++) {
+        unsigned int count = packed->solution[i] & PACKED_SOLUTION_COUNT_MASK;
+        unsigned int suit = packed->solution[i] >> PACKED_SOLUTION_SUIT_SHIFT;
+        // an empty solution stack is a zero byte
+        if (count > NUM_VALUES || suit >= NUM_SUITS || (count == 0 && packed->solution[i] != 0)) {
+            return false;
+        }
+        for (unsigned int value = 0; value < count; value++) {
+            if (seen[suit * NUM_VALUES + value]) {
+                return false;
+            }
+            seen[suit * NUM_VALUES + value] = true;
+        }
+        total_solved += count;
+    }
+    if (num_cards + total_solved != NUM_CARDS) {
+        return false;
+    }
+    for (unsigned int i = 0; i < num_cards; i++) {
+        unsigned int id = packed->cards[i] & PACKED_ID_MASK;
+        if ((packed->cards[i] & ~(PACKED_ID_MASK | PACKED_VISIBLE)) || id >= NUM_CARDS || seen[id]) {
+            return false;
+        }
+        seen[id] = true;
+    }
+#if PASS_LIMIT
+    if (packed->passes > PASS_LIMIT) {
+        return false;
+    }
+#endif
+    return true;
+}
@@ -0,0 +1,67 @@
+#ifndef __PACKED_H__
+#define __PACKED_H__
+#include <stdbool.h>
+#include <stdint.h>
+#include "Board.h"
+#include "Card.h"
+#include "Deck.h"
+
+// a card in one byte: the low 6 bits are the card's identity
+// (suit * NUM_VALUES + value), bit 6 is set when the card is face up
+typedef uint8_t PackedCard;
+
+#define PACKED_ID_MASK 0x3f
+#define PACKED_VISIBLE 0x40
+#define NUM_CARDS      52
+
+// the cards of a packed board are stored back to back in segments, in this order
+#define PACKED_DECK         0
+#define PACKED_DISCARD      1
+#define PACKED_WORKING_0    2
+#define NUM_PACKED_SEGMENTS (PACKED_WORKING_0+NUM_WORKING_STACKS)
+
+// solution stacks only ever hold one suit in order, so each is kept in a byte:
+// the low 4 bits are the number of cards and the next 2 bits the suit
+#define PACKED_SOLUTION_COUNT_MASK 0x0f
+#define PACKED_SOLUTION_SUIT_SHIFT 4
+
+// a whole position in 65 bytes. Cards not on a solution stack live in "cards",
+// split into segments whose lengths are kept in "num_cards". When the passes
+// through the deck are limited, one more byte counts them.
+typedef struct {
+    PackedCard cards[NUM_CARDS];
+    uint8_t num_cards[NUM_PACKED_SEGMENTS];
+    uint8_t solution[NUM_SOLUTION_STACKS];
+#if PASS_LIMIT
+    uint8_t passes;
+#endif
+} PackedBoard;
+
+// whether or not the discard pile of a packed board can be turned back into the deck
+#if PASS_LIMIT
+#define PACKED_CAN_RECYCLE(packed) CAN_RECYCLE((packed)->passes)
+#else
+#define PACKED_CAN_RECYCLE(packed) true
+#endif
+
+// handler struct for converting to and from packed positions, and for the
+// rules of the game played directly on them
+typedef struct {
+    PackedCard (*pack_card)(Card);
+    Card (*unpack_card)(PackedCard);
+    unsigned int (*pack_stack)(const CardStack *, PackedCard *);
+    CardStack (*unpack_stack)(const PackedCard *, unsigned int num_cards);
+    PackedBoard (*pack)(const Board *);
+    Board (*unpack)(const PackedBoard *);
+    bool (*is_legal)(const PackedBoard *, Move);
+    bool (*apply_move)(PackedBoard *, Move);
+    bool (*is_won)(const PackedBoard *);
+    bool (*is_safe_for_solution)(const PackedBoard *, PackedCard);
+    bool (*safe_solution_move)(const PackedBoard *, Move *);
+    PackedBoard (*canonicalize)(const PackedBoard *);
+    bool (*is_valid)(const PackedBoard *);
+} PackedFunctions;
+
+const PackedFunctions *get_packed_functions();
+
+#endif /* __PACKED_H__ */
@@ -0,0 +1,164 @@
+#include "Policy.h"
+#include "Board.h"
+#include "Card.h"
+#include "Packed.h"
+#include "Random.h"
+#include <stdbool.h>
+#include <string.h>
+
+const Policy *find_policy(const char *name);
+const Policy *all_policies(unsigned int *num_policies);
+
+unsigned int choose_random(const PackedBoard *, const Move *moves, unsigned int num_moves, Rng *);
+unsigned int choose_greedy(const PackedBoard *, const Move *moves, unsigned int num_moves, Rng *);
+unsigned int choose_heuristic(const PackedBoard *, const Move *moves, unsigned int num_moves, Rng *);
+
+const Policy policies[] = {
+    { "random",    "any legal move, picked uniformly",                           choose_random },
+    { "greedy",    "solution moves, then uncovering, then the deck, then flip",  choose_greedy },
+    { "heuristic", "scores every move, keeping cards back that may be needed",   choose_heuristic }
+};
+#define NUM_POLICIES (sizeof(policies) / sizeof(policies[0]))
+
+const PolicyFunctions policy_functions = {
+    .find=find_policy,
+    .all=all_policies
+};
+
+// returns pointer to the handler for policy functions
+const PolicyFunctions *get_policy_functions() {
+    return &policy_functions;
+}
+
+// returns the policy with the given name, or NULL if there is none
+const Policy *find_policy(const char *name) {
+    for (unsigned int i = 0; i < NUM_POLICIES; i++) {
+        if (strcmp(policies[i].name, name) == 0) {
+            return &policies[i];
+        }
+    }
+    return NULL;
+}
+// returns every policy, writing how many there are into "num_policies"
+const Policy *all_policies(unsigned int *num_policies) {
+    *num_policies = NUM_POLICIES;
+    return policies;
+}
+
+// returns the card at the given index of a working stack
+static PackedCard working_card(const PackedBoard *packed, int stack, unsigned int index) {
+    unsigned int start = 0;
+    for (int i = 0; i < PACKED_WORKING_0 + stack; i++) {
+        start += packed->num_cards[i];
+    }
+    return packed->cards[start + index];
+}
+// returns the number of face down cards in a working stack
+static unsigned int face_down_cards(const PackedBoard *packed, int stack) {
+    unsigned int n = 0;
+    while (n < packed->num_cards[PACKED_WORKING_0+stack] && !(working_card(packed, stack, n) & PACKED_VISIBLE)) {
+        n++;
+    }
+    return n;
+}
+// returns the card a move picks up
+static PackedCard moved_card(const PackedBoard *packed, Move move) {
+    if (move.from == DECK_STACK) {
+        return packed->cards[packed->num_cards[PACKED_DECK] + packed->num_cards[PACKED_DISCARD] - 1];
+    }
+    if (move.from >= SOLUTION_0 && move.from <= SOLUTION_3) {
+        uint8_t solution = packed->solution[move.from-SOLUTION_0];
+        return (solution >> PACKED_SOLUTION_SUIT_SHIFT) * NUM_VALUES + (solution & PACKED_SOLUTION_COUNT_MASK) - 1;
+    }
+    return working_card(packed, move.from-WORKING_0, move.index);
+}
+// returns whether or not a move turns over a face down card
+static bool uncovers(const PackedBoard *packed, Move move) {
+    return move.type == MOVE_CARDS && move.from >= WORKING_0 && move.from <= WORKING_6
+        && move.index > 0 && !(working_card(packed, move.from-WORKING_0, move.index-1) & PACKED_VISIBLE);
+}
+// returns whether or not a move can never make progress: a whole stack onto
+// an empty one, part of a face up run onto an equivalent card, or a card
+// taken back off a solution stack
+static bool is_pointless(const PackedBoard *packed, Move move) {
+    if (move.type == MOVE_FLIP || move.from == DECK_STACK) {
+        return false;
+    }
+    if (move.from >= SOLUTION_0 && move.from <= SOLUTION_3) {
+        return true;
+    }
+    if (move.to >= SOLUTION_0 && move.to <= SOLUTION_3) {
+        return false;
+    }
+    return move.index == 0 ? packed->num_cards[PACKED_WORKING_0 + move.to - WORKING_0] == 0 : !uncovers(packed, move);
+}
+
+// picks any legal move
+unsigned int choose_random(const PackedBoard *packed, const Move *moves, unsigned int num_moves, Rng *rng) {
+    return get_random_functions()->below(rng, num_moves);
+}
+
+// picks the first move of the best kind available: onto a solution stack,
+// then one that turns over a card, then one from the deck, then a flip
+unsigned int choose_greedy(const PackedBoard *packed, const Move *moves, unsigned int num_moves, Rng *rng) {
+    unsigned int best = num_moves;
+    int best_kind = 4;
+    for (unsigned int i = 0; i < num_moves; i++) {
+        int kind;
+        if (moves[i].type == MOVE_FLIP) {
+            kind = 3;
+        } else if (moves[i].to >= SOLUTION_0 && moves[i].to <= SOLUTION_3) {
+            kind = 0;
+        } else if (uncovers(packed, moves[i])) {
+            kind = 1;
+        } else if (moves[i].from == DECK_STACK) {
+            kind = 2;
+        } else {
+            continue;
+        }
+        if (kind < best_kind) {
+            best = i;
+            best_kind = kind;
+        }
+    }
+    // only pointless moves are left, so play one of them at random
+    return best < num_moves ? best : get_random_functions()->below(rng, num_moves);
+}
+
+// scores every move and picks the best, breaking ties at random. Safe
+// solution moves come first, then turning over cards in the stacks with the
+// most face down cards, then kings into empty stacks, plays from the deck and
+// other solution moves, and flips last.
+unsigned int choose_heuristic(const PackedBoard *packed, const Move *moves, unsigned int num_moves, Rng *rng) {
+    const RandomFunctions *rfuncs = get_random_functions();
+    unsigned int best = 0, ties = 0;
+    int best_score = -1000;
+    for (unsigned int i = 0; i < num_moves; i++) {
+        Move move = moves[i];
+        int score;
+        if (move.type == MOVE_FLIP) {
+            score = 0;
+        } else if (is_pointless(packed, move)) {
+            score = -100;
+        } else if (move.to >= SOLUTION_0 && move.to <= SOLUTION_3) {
+            score = get_packed_functions()->is_safe_for_solution(packed, moved_card(packed, move)) ? 100 : 20;
+        } else if (uncovers(packed, move)) {
+            score = 50 + face_down_cards(packed, move.from-WORKING_0);
+        } else if (packed->num_cards[PACKED_WORKING_0 + move.to - WORKING_0] == 0) {
+            // a king into an empty stack is worth more if it frees cards behind it
+            score = move.from == DECK_STACK ? 30 : 40;
+        } else if (move.from == DECK_STACK) {
+            score = 25;
+        } else {
+            score = 10;
+        }
+        if (score > best_score) {
+            best = i;
+            best_score = score;
+            ties = 1;
+        } else if (score == best_score && rfuncs->below(rng, ++ties) == 0) {
+            best = i;
+        }
+    }
+    return best;
+}
@@ -0,0 +1,23 @@
+#ifndef __POLICY_H__
+#define __POLICY_H__
+#include "Board.h"
+#include "Packed.h"
+#include "Random.h"
+
+// a strategy for playing the game: given the legal moves from a position,
+// returns the index of the one to play
+typedef struct {
+    const char *name;
+    const char *description;
+    unsigned int (*choose)(const PackedBoard *, const Move *moves, unsigned int num_moves, Rng *);
+} Policy;
+
+// handler struct for looking up the available policies
+typedef struct {
+    const Policy *(*find)(const char *name);
+    const Policy *(*all)(unsigned int *num_policies);
+} PolicyFunctions;
+
+const PolicyFunctions *get_policy_functions();
+
+#endif /* __POLICY_H__ */
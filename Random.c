@@ -0,0 +1,70 @@
+#include "Random.h"
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+
+void seed_rng(Rng *, uint64_t seed);
+uint64_t next_random(Rng *);
+unsigned int random_below(Rng *, unsigned int bound);
+uint64_t fresh_seed(void);
+
+const RandomFunctions random_functions = {
+    .seed=seed_rng,
+    .next=next_random,
+    .below=random_below,
+    .fresh_seed=fresh_seed
+};
+
+// returns pointer to the handler for random functions
+const RandomFunctions *get_random_functions() {
+    return &random_functions;
+}
+
+// steps a splitmix64 generator, used to spread a seed over the full state
+static uint64_t splitmix64(uint64_t *x) {
+    uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+static uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+// seeds the generator. The same seed always gives the same sequence.
+void seed_rng(Rng *rng, uint64_t seed) {
+    for (int i = 0; i < 4; i++) {
+        rng->s[i] = splitmix64(&seed);
+    }
+}
+// returns the next 64 random bits
+uint64_t next_random(Rng *rng) {
+    uint64_t *s = rng->s;
+    uint64_t result = rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+}
+// returns a uniformly distributed number in [0, bound)
+unsigned int random_below(Rng *rng, unsigned int bound) {
+    // reject the few values that would make the low end more likely
+    uint64_t threshold = -(uint64_t)bound % bound;
+    uint64_t r;
+    do {
+        r = next_random(rng);
+    } while (r < threshold);
+    return r % bound;
+}
+// returns a seed that differs between runs, even ones started in the same second
+uint64_t fresh_seed(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    uint64_t x = (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+    x ^= (uint64_t)getpid() << 32;
+    return splitmix64(&x);
+}
@@ -0,0 +1,21 @@
+#ifndef __RANDOM_H__
+#define __RANDOM_H__
+#include <stdint.h>
+
+// state of a xoshiro256** generator. Each user keeps its own, so separate
+// threads can draw numbers without sharing any state.
+typedef struct {
+    uint64_t s[4];
+} Rng;
+
+// handler struct for all functions related to random numbers
+typedef struct {
+    void (*seed)(Rng *, uint64_t seed);
+    uint64_t (*next)(Rng *);
+    unsigned int (*below)(Rng *, unsigned int bound);
+    uint64_t (*fresh_seed)(void);
+} RandomFunctions;
+
+const RandomFunctions *get_random_functions();
+
+#endif /* __RANDOM_H__ */
@@ -0,0 +1,51 @@
+#ifndef __RENDER_H__
+#define __RENDER_H__
+#include <stdbool.h>
+#include <stdio.h>
+#include <wchar.h>
+
+// size of a card on screen
+#define CARD_HEIGHT 4
+#define CARD_WIDTH  6
+
+// the most card-sized glyphs a backend has to hold
+#define MAX_GLYPHS 512
+
+// one character cell on screen: a character and the color pair it is drawn in,
+// 0 for the terminal's default
+typedef struct {
+    wchar_t ch;
+    short color;
+} Cell;
+
+// a card-sized picture
+typedef struct {
+    Cell cells[CARD_HEIGHT][CARD_WIDTH];
+} Glyph;
+
+// handler struct for where drawing ends up. Glyphs are handed over once with
+// load_glyph, so the backend can keep them ready in its own form, and are then
+// drawn by id.
+typedef struct {
+    void (*erase)(void);
+    void (*text)(int y, int x, const char *text);
+    void (*load_glyph)(unsigned int id, const Glyph *);
+    void (*glyph)(unsigned int id, int y, int x);
+    int (*lines)(void);
+    int (*cols)(void);
+} RenderBackend;
+
+// handler struct for the in-memory backend, which draws into a grid of cells
+// instead of a terminal
+typedef struct {
+    const RenderBackend *backend;
+    bool (*init)(int lines, int cols);
+    void (*free)(void);
+    const Cell *(*cells)(void);
+    void (*write)(FILE *, bool colors);
+} MemoryRenderFunctions;
+
+const RenderBackend *get_curses_backend();
+const MemoryRenderFunctions *get_memory_render_functions();
+
+#endif /* __RENDER_H__ */
@@ -0,0 +1,211 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "Board.h"
+#include "Draw.h"
+#include "GameState.h"
+#include "Latency.h"
+#include "Policy.h"
+#include "Render.h"
+#include "Simulator.h"
+
+// size of the off-screen grid, enough for the tallest possible working stack
+#define RENDER_LINES 40
+#define RENDER_COLS  80
+
+// longest game recorded for rendering
+#define MAX_RECORDED_MOVES 500
+
+// a position from a recorded game, with the spots the move into it changed
+typedef struct {
+    Board board;
+    unsigned int dirty;
+} RecordedFrame;
+
+bool parse_args(int argc, char *argv[], uint64_t *deal_number, unsigned long *num_frames,
+                const char **golden_file, const char **write_file);
+unsigned int record_frames(uint64_t deal_number, RecordedFrame *frames);
+uint64_t time_frames(const RecordedFrame *frames, unsigned int num_positions, unsigned long num_frames, bool incremental);
+bool write_golden(FILE *file, const RecordedFrame *frames, unsigned int num_positions);
+bool compare_golden(const char *path, const RecordedFrame *frames, unsigned int num_positions);
+
+int main(int argc, char *argv[]) {
+    const MemoryRenderFunctions *mfuncs = get_memory_render_functions();
+
+    uint64_t deal_number = 1;
+    unsigned long num_frames = 100000;
+    const char *golden_file = NULL, *write_file = NULL;
+    if (!parse_args(argc, argv, &deal_number, &num_frames, &golden_file, &write_file)) {
+        fprintf(stderr, "usage: %s [--deal N] [--frames N] [--golden FILE | --write-golden FILE]\n", argv[0]);
+        return 1;
+    }
+
+    RecordedFrame *frames = malloc(sizeof(RecordedFrame) * (MAX_RECORDED_MOVES+1));
+    if (frames == NULL || !mfuncs->init(RENDER_LINES, RENDER_COLS)) {
+        fprintf(stderr, "%s: out of memory\n", argv[0]);
+        return 1;
+    }
+    get_draw_functions()->set_backend(mfuncs->backend);
+    unsigned int num_positions = record_frames(deal_number, frames);
+    if (num_positions == 0) {
+        fprintf(stderr, "%s: out of memory\n", argv[0]);
+        return 1;
+    }
+
+    int status = 0;
+    if (write_file) {
+        FILE *file = fopen(write_file, "w");
+        if (file == NULL || !write_golden(file, frames, num_positions) || fclose(file) != 0) {
+            fprintf(stderr, "%s: could not write %s\n", argv[0], write_file);
+            status = 1;
+        } else {
+            printf("wrote %u frames to %s\n", num_positions, write_file);
+        }
+    } else if (golden_file) {
+        status = compare_golden(golden_file, frames, num_positions) ? 0 : 1;
+    }
+
+    if (status == 0 && num_frames) {
+        uint64_t full = time_frames(frames, num_positions, num_frames, false);
+        uint64_t incremental = time_frames(frames, num_positions, num_frames, true);
+        printf("deal %" PRIu64 ", %u positions, %lu frames each\n", deal_number, num_positions, num_frames);
+        printf("full frame         %8.1f ns/frame\n", (double)full / num_frames);
+        printf("incremental frame  %8.1f ns/frame\n", (double)incremental / num_frames);
+    }
+
+    mfuncs->free();
+    free(frames);
+    return status;
+}
+
+// reads the command line options. Returns false if they are not valid.
+bool parse_args(int argc, char *argv[], uint64_t *deal_number, unsigned long *num_frames,
+                const char **golden_file, const char **write_file) {
+    for (int i = 1; i < argc; i++) {
+        char *end = "";
+        if (i+1 >= argc) {
+            return false;
+        }
+        if (strcmp(argv[i], "--deal") == 0) {
+            *deal_number = strtoull(argv[++i], &end, 10);
+        } else if (strcmp(argv[i], "--frames") == 0) {
+            *num_frames = strtoul(argv[++i], &end, 10);
+        } else if (strcmp(argv[i], "--golden") == 0) {
+            *golden_file = argv[++i];
+        } else if (strcmp(argv[i], "--write-golden") == 0) {
+            *write_file = argv[++i];
+        } else {
+            return false;
+        }
+        if (*end != '\0') {
+            return false;
+        }
+    }
+    return !(*golden_file && *write_file);
+}
+
+// plays the deal with the heuristic policy, keeping every position along the
+// way. Returns the number of positions kept.
+unsigned int record_frames(uint64_t deal_number, RecordedFrame *frames) {
+    Board *positions = malloc(sizeof(Board) * (MAX_RECORDED_MOVES+1));
+    Move moves[MAX_RECORDED_MOVES];
+    if (positions == NULL) {
+        return 0;
+    }
+    GameResult result = get_simulator_functions()->record(deal_number, get_policy_functions()->find("heuristic"),
+                                                          MAX_RECORDED_MOVES, positions, moves);
+    frames[0] = (RecordedFrame){ positions[0], DIRTY_SCREEN };
+    for (unsigned int i = 0; i < result.num_moves; i++) {
+        Move move = moves[i];
+        unsigned int dirty = move.type == MOVE_FLIP ? SPOT_BIT(DECK_STACK) : SPOT_BIT(move.from) | SPOT_BIT(move.to);
+        frames[i+1] = (RecordedFrame){ positions[i+1], dirty };
+    }
+    free(positions);
+    return result.num_moves + 1;
+}
+
+// returns a cursor with nothing selected, redrawing the spots given
+static GameState frame_state(unsigned int dirty) {
+    return (GameState){ .spot = WORKING_0, .index = 0, .saved_spot = NO_SPOT, .saved_index = 0,
+                        .help_menu_up = false, .latency_hud_up = false,
+                        .hint_up = false, .hint_from = NO_SPOT, .hint_to = NO_SPOT, .hint_index = 0, .winnable = WINNABLE_NONE, .dirty = dirty };
+}
+
+// draws "num_frames" frames, cycling through the positions, and returns the
+// time taken in nanoseconds. Full frames redraw the whole screen; incremental
+// frames redraw only the spots the last move changed.
+uint64_t time_frames(const RecordedFrame *frames, unsigned int num_positions, unsigned long num_frames, bool incremental) {
+    const DrawFunctions    *dfuncs = get_draw_functions();
+    const LatencyFunctions *lfuncs = get_latency_functions();
+    Screen screen = { .cells_written = 0, .total_cells_written = 0, .frames = 0 };
+
+    uint64_t start = lfuncs->now();
+    for (unsigned long i = 0; i < num_frames; i++) {
+        const RecordedFrame *frame = &frames[i % num_positions];
+        GameState state = frame_state(incremental ? frame->dirty : DIRTY_SCREEN);
+        dfuncs->screen((Board *)&frame->board, &state, &screen);
+    }
+    return lfuncs->now() - start;
+}
+
+// writes a full frame of every position, each after a line with its number
+bool write_golden(FILE *file, const RecordedFrame *frames, unsigned int num_positions) {
+    const MemoryRenderFunctions *mfuncs = get_memory_render_functions();
+    Screen screen = { .cells_written = 0, .total_cells_written = 0, .frames = 0 };
+    for (unsigned int i = 0; i < num_positions; i++) {
+        GameState state = frame_state(DIRTY_SCREEN);
+        get_draw_functions()->screen((Board *)&frames[i].board, &state, &screen);
+        fprintf(file, "frame %u\n", i);
+        mfuncs->write(file, true);
+    }
+    return !ferror(file);
+}
+
+// draws every position and compares the frames with a golden file, reporting
+// the first difference. Returns whether or not they all match.
+bool compare_golden(const char *path, const RecordedFrame *frames, unsigned int num_positions) {
+    char *expected = NULL, *actual = NULL;
+    size_t expected_size = 0, actual_size = 0;
+
+    FILE *file = fopen(path, "r");
+    FILE *memory = open_memstream(&actual, &actual_size);
+    if (file == NULL || memory == NULL) {
+        fprintf(stderr, "could not read %s\n", path);
+        return false;
+    }
+    FILE *expected_memory = open_memstream(&expected, &expected_size);
+    int c;
+    while ((c = fgetc(file)) != EOF) {
+        fputc(c, expected_memory);
+    }
+    fclose(file);
+    fclose(expected_memory);
+    write_golden(memory, frames, num_positions);
+    fclose(memory);
+
+    // finds the first line that differs
+    unsigned int line = 1, frame = 0;
+    size_t i = 0;
+    while (i < expected_size && i < actual_size && expected[i] == actual[i]) {
+        if (actual[i] == '\n') {
+            line++;
+            if (strncmp(&actual[i+1], "frame ", 6) == 0) {
+                frame = strtoul(&actual[i+7], NULL, 10);
+            }
+        }
+        i++;
+    }
+    bool match = i == expected_size && i == actual_size;
+    if (match) {
+        printf("%u frames match %s\n", num_positions, path);
+    } else {
+        printf("frame %u differs from %s at line %u\n", frame, path, line);
+    }
+    free(expected);
+    free(actual);
+    return match;
+}
@@ -0,0 +1,246 @@
+#include "Replay.h"
+#include "Board.h"
+#include "Journal.h"
+#include "Packed.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+bool open_writer(ReplayWriter *, FILE *, uint64_t deal_number, unsigned int keyframe_interval);
+bool replay_record(ReplayWriter *, Move);
+bool close_writer(ReplayWriter *);
+bool open_replay(Replay *, const uint8_t *data, size_t size);
+bool replay_seek(const Replay *, uint32_t move_number, Board *);
+bool replay_move(const Replay *, uint32_t move_number, JournalEntry *);
+
+const ReplayFunctions replay_functions = {
+    .open_writer=open_writer,
+    .record=replay_record,
+    .close_writer=close_writer,
+    .open=open_replay,
+    .seek=replay_seek,
+    .move=replay_move
+};
+
+_Static_assert(sizeof(PackedBoard) == NUM_CARDS + NUM_PACKED_SEGMENTS + NUM_SOLUTION_STACKS + (PASS_LIMIT != 0),
+               "keyframes are written as the bytes of a packed board");
+
+// returns pointer to the handler for replay functions
+const ReplayFunctions *get_replay_functions() {
+    return &replay_functions;
+}
+
+// stores a number in little endian order
+static void put_u32(uint8_t *bytes, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        bytes[i] = value >> (8*i);
+    }
+}
+// reads a number stored in little endian order
+static uint32_t get_u32(const uint8_t *bytes) {
+    return bytes[0] | bytes[1] << 8 | bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+}
+// writes bytes to the replay file, keeping track of the offset
+static bool write_bytes(ReplayWriter *writer, const void *bytes, uint32_t size) {
+    writer->offset += size;
+    return fwrite(bytes, 1, size, writer->file) == size;
+}
+
+// starts a replay of a deal, writing its header. A keyframe is written after
+// every "keyframe_interval" moves, which must be from 1 to 255.
+bool open_writer(ReplayWriter *writer, FILE *file, uint64_t deal_number, unsigned int keyframe_interval) {
+    *writer = (ReplayWriter){ .file=file, .board=get_board_functions()->fresh_board(),
+                              .keyframe_interval=keyframe_interval, .num_moves=0, .offset=0,
+                              .keyframes=NULL, .num_keyframes=0, .capacity=0 };
+    get_board_functions()->deal(&writer->board, deal_number);
+    if (keyframe_interval == 0 || keyframe_interval > 255) {
+        return false;
+    }
+
+    uint8_t header[REPLAY_HEADER_SIZE] = { 0 };
+    memcpy(header, REPLAY_MAGIC, 4);
+    header[4] = REPLAY_VERSION;
+    header[5] = keyframe_interval;
+    header[6] = DRAW_COUNT - 1;
+    header[7] = PASS_LIMIT;
+    put_u32(&header[8], deal_number);
+    put_u32(&header[12], deal_number >> 32);
+    return write_bytes(writer, header, REPLAY_HEADER_SIZE);
+}
+
+// plays a move on the writer's board and writes its record, and a keyframe if
+// one is due. Returns false if the move is not legal or writing fails.
+bool replay_record(ReplayWriter *writer, Move move) {
+    uint8_t bytes[2];
+    uint32_t size = 1;
+    if (move.type == MOVE_FLIP) {
+        bytes[0] = REPLAY_FLIP;
+    } else {
+        unsigned int num_cards = move.from >= WORKING_0 && move.from <= WORKING_6
+            ? writer->board.working_stacks[move.from-WORKING_0].num_cards - move.index
+            : 1;
+        bytes[0] = move.from << 4 | move.to;
+        if (num_cards > 1) {
+            bytes[1] = bytes[0];
+            bytes[0] = REPLAY_RUN | num_cards;
+            size = 2;
+        }
+    }
+    if (!get_board_functions()->apply_move(&writer->board, move) || !write_bytes(writer, bytes, size)) {
+        return false;
+    }
+    if (++writer->num_moves % writer->keyframe_interval) {
+        return true;
+    }
+
+    if (writer->num_keyframes == writer->capacity) {
+        uint32_t capacity = writer->capacity ? writer->capacity * 2 : 16;
+        uint32_t *keyframes = realloc(writer->keyframes, capacity * sizeof(uint32_t));
+        if (keyframes == NULL) {
+            return false;
+        }
+        writer->keyframes = keyframes;
+        writer->capacity = capacity;
+    }
+    writer->keyframes[writer->num_keyframes++] = writer->offset;
+    PackedBoard packed = get_packed_functions()->pack(&writer->board);
+    return write_bytes(writer, &packed, REPLAY_KEYFRAME_SIZE);
+}
+
+// finishes a replay by writing the keyframe index and the footer. The file is
+// left open. Returns false if writing fails.
+bool close_writer(ReplayWriter *writer) {
+    uint32_t index_offset = writer->offset;
+    bool ok = true;
+    for (uint32_t i = 0; i < writer->num_keyframes && ok; i++) {
+        uint8_t bytes[4];
+        put_u32(bytes, writer->keyframes[i]);
+        ok = write_bytes(writer, bytes, 4);
+    }
+    uint8_t footer[REPLAY_FOOTER_SIZE];
+    put_u32(&footer[0], writer->num_moves);
+    put_u32(&footer[4], writer->num_keyframes);
+    put_u32(&footer[8], index_offset);
+    memcpy(&footer[12], REPLAY_END_MAGIC, 4);
+    ok = ok && write_bytes(writer, footer, REPLAY_FOOTER_SIZE);
+
+    free(writer->keyframes);
+    writer->keyframes = NULL;
+    writer->num_keyframes = writer->capacity = 0;
+    return ok && fflush(writer->file) == 0;
+}
+
+// checks the header and footer of a replay held in memory. Returns false if
+// it is not a whole replay file, or was played with other rules.
+bool open_replay(Replay *replay, const uint8_t *data, size_t size) {
+    if (size < REPLAY_HEADER_SIZE + REPLAY_FOOTER_SIZE || memcmp(data, REPLAY_MAGIC, 4) != 0
+        || data[4] != REPLAY_VERSION || data[5] == 0 || data[6] != DRAW_COUNT - 1 || data[7] != PASS_LIMIT) {
+        return false;
+    }
+    const uint8_t *footer = data + size - REPLAY_FOOTER_SIZE;
+    if (memcmp(&footer[12], REPLAY_END_MAGIC, 4) != 0) {
+        return false;
+    }
+    *replay = (Replay){ .data=data, .size=size,
+                        .deal_number=get_u32(&data[8]) | (uint64_t)get_u32(&data[12]) << 32,
+                        .keyframe_interval=data[5], .num_moves=get_u32(&footer[0]),
+                        .num_keyframes=get_u32(&footer[4]), .index=data + get_u32(&footer[8]) };
+    uint64_t index_end = get_u32(&footer[8]) + (uint64_t)replay->num_keyframes * 4;
+    return replay->num_keyframes == replay->num_moves / replay->keyframe_interval
+        && get_u32(&footer[8]) >= REPLAY_HEADER_SIZE && index_end == size - REPLAY_FOOTER_SIZE;
+}
+
+// finds the records of the block of moves a move is in, which start at the
+// keyframe before it. Returns false if the index points outside the moves.
+static bool block_start(const Replay *replay, uint32_t block, const uint8_t **records, const uint8_t **keyframe) {
+    *keyframe = NULL;
+    *records = replay->data + REPLAY_HEADER_SIZE;
+    if (block > 0) {
+        uint32_t offset = get_u32(&replay->index[(block-1) * 4]);
+        if (offset < REPLAY_HEADER_SIZE || offset + REPLAY_KEYFRAME_SIZE > (size_t)(replay->index - replay->data)) {
+            return false;
+        }
+        *keyframe = replay->data + offset;
+        *records = *keyframe + REPLAY_KEYFRAME_SIZE;
+    }
+    return true;
+}
+// decodes the move record at "*records", moving past it. Returns false if the
+// record is not valid or runs past "end".
+static bool decode(const uint8_t **records, const uint8_t *end, JournalEntry *entry) {
+    const uint8_t *p = *records;
+    if (p >= end) {
+        return false;
+    }
+    *entry = (JournalEntry){ .from=DECK_STACK, .to=DECK_STACK, .num_cards=1, .flags=JOURNAL_FLIP };
+    if (*p == REPLAY_FLIP) {
+        *records = p+1;
+        return true;
+    }
+    entry->flags = 0;
+    if ((*p & REPLAY_RUN_MASK) == REPLAY_RUN) {
+        entry->num_cards = *p++ & ~REPLAY_RUN_MASK;
+        if (p >= end || entry->num_cards < 2) {
+            return false;
+        }
+    }
+    entry->from = *p >> 4;
+    entry->to = *p & 0x0f;
+    *records = p+1;
+    return entry->from < NO_SPOT && entry->to < DECK_STACK;
+}
+
+// sets the board to the position after the first "move_number" moves, starting
+// from the keyframe before it. Returns false if the replay has fewer moves or
+// holds a keyframe or a move that is not legal.
+bool replay_seek(const Replay *replay, uint32_t move_number, Board *board) {
+    if (move_number > replay->num_moves) {
+        return false;
+    }
+    uint32_t block = move_number / replay->keyframe_interval;
+    const uint8_t *records, *keyframe;
+    if (!block_start(replay, block, &records, &keyframe)) {
+        return false;
+    }
+    if (keyframe) {
+        PackedBoard packed;
+        memcpy(&packed, keyframe, REPLAY_KEYFRAME_SIZE);
+        // replays come from outside, so a keyframe is checked before it is unpacked
+        if (!get_packed_functions()->is_valid(&packed)) {
+            return false;
+        }
+        *board = get_packed_functions()->unpack(&packed);
+    } else {
+        *board = get_board_functions()->fresh_board();
+        get_board_functions()->deal(board, replay->deal_number);
+    }
+
+    const uint8_t *end = replay->index;
+    for (uint32_t i = block * replay->keyframe_interval; i < move_number; i++) {
+        JournalEntry entry;
+        if (!decode(&records, end, &entry)
+            || !get_board_functions()->apply_move(board, get_journal_functions()->entry_move(board, entry))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// gives the record of a move: its spots and number of cards, with
+// JOURNAL_FLIP set for flips. Returns false if there is no such move.
+bool replay_move(const Replay *replay, uint32_t move_number, JournalEntry *entry) {
+    if (move_number >= replay->num_moves) {
+        return false;
+    }
+    uint32_t block = move_number / replay->keyframe_interval;
+    const uint8_t *records, *keyframe;
+    if (!block_start(replay, block, &records, &keyframe)) {
+        return false;
+    }
+    for (uint32_t i = block * replay->keyframe_interval; i <= move_number; i++) {
+        if (!decode(&records, replay->index, entry)) {
+            return false;
+        }
+    }
+    return true;
+}
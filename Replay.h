@@ -0,0 +1,77 @@
+#ifndef __REPLAY_H__
+#define __REPLAY_H__
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "Board.h"
+#include "Journal.h"
+#include "Packed.h"
+
+// A replay file is written front to back in one pass, so it can be streamed:
+//
+//   header    16 bytes: "SRPL", version, keyframe interval K, the number of
+//             cards a flip turns over less one, the limit on passes through
+//             the deck (0 for none), then the deal number
+//   moves     one record per move, with the packed position after every K
+//             moves (a keyframe) written straight after the K-th record
+//   index     the file offset of each keyframe, 4 bytes each
+//   footer    16 bytes: number of moves, number of keyframes, offset of the
+//             index, then "SRPE"
+//
+// A move record is 1 byte for a flip or a move of one card, and 2 bytes for
+// a move of several cards between working stacks. All numbers are little
+// endian and nothing needs aligning, so a file can be read straight out of
+// memory. Any position is reached from the keyframe before it, or from the
+// deal for the first K moves, by playing at most K-1 moves.
+#define REPLAY_MAGIC            "SRPL"
+#define REPLAY_END_MAGIC        "SRPE"
+#define REPLAY_VERSION          1
+#define REPLAY_HEADER_SIZE      16
+#define REPLAY_FOOTER_SIZE      16
+#define REPLAY_KEYFRAME_SIZE    ((unsigned int)sizeof(PackedBoard))
+#define REPLAY_DEFAULT_INTERVAL 32
+
+// move record bytes. A single byte "from << 4 | to" moves one card. A run
+// byte holding the number of cards is followed by a "from << 4 | to" byte.
+#define REPLAY_FLIP     0xff
+#define REPLAY_RUN      0xd0
+#define REPLAY_RUN_MASK 0xf0
+
+// writes a replay to a file as the moves are played
+typedef struct {
+    FILE *file;
+    Board board; // the position after the moves recorded so far
+    unsigned int keyframe_interval;
+    uint32_t num_moves;
+    uint32_t offset;
+    uint32_t *keyframes;
+    uint32_t num_keyframes;
+    uint32_t capacity;
+} ReplayWriter;
+
+// a replay file held in memory, e.g. mapped from disk. Points into the data
+// rather than copying it.
+typedef struct {
+    const uint8_t *data;
+    size_t size;
+    uint64_t deal_number;
+    unsigned int keyframe_interval;
+    uint32_t num_moves;
+    uint32_t num_keyframes;
+    const uint8_t *index;
+} Replay;
+
+// handler struct for writing and reading replays
+typedef struct {
+    bool (*open_writer)(ReplayWriter *, FILE *, uint64_t deal_number, unsigned int keyframe_interval);
+    bool (*record)(ReplayWriter *, Move);
+    bool (*close_writer)(ReplayWriter *);
+    bool (*open)(Replay *, const uint8_t *data, size_t size);
+    bool (*seek)(const Replay *, uint32_t move_number, Board *);
+    bool (*move)(const Replay *, uint32_t move_number, JournalEntry *);
+} ReplayFunctions;
+
+const ReplayFunctions *get_replay_functions();
+
+#endif /* __REPLAY_H__ */
@@ -0,0 +1,189 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "Board.h"
+#include "Draw.h"
+#include "GameState.h"
+#include "Journal.h"
+#include "Latency.h"
+#include "Packed.h"
+#include "Render.h"
+#include "Replay.h"
+
+// size of the off-screen grid positions are drawn into
+#define REPLAY_LINES 40
+#define REPLAY_COLS  80
+
+// no move number given
+#define NO_MOVE UINT32_MAX
+
+bool parse_args(int argc, char *argv[], const char **replay_file, uint32_t *move_number, bool *check);
+bool show_move(const Replay *replay, uint32_t move_number);
+bool check_replay(const Replay *replay);
+void print_entry(JournalEntry entry);
+
+// names of the spots, for printing moves
+const char *spot_names[] = {
+    "solution 1", "solution 2", "solution 3", "solution 4",
+    "stack 1", "stack 2", "stack 3", "stack 4", "stack 5", "stack 6", "stack 7",
+    "deck"
+};
+
+int main(int argc, char *argv[]) {
+    const char *replay_file = NULL;
+    uint32_t move_number = NO_MOVE;
+    bool check = false;
+    if (!parse_args(argc, argv, &replay_file, &move_number, &check)) {
+        fprintf(stderr, "usage: %s FILE [--move N] [--check]\n", argv[0]);
+        return 1;
+    }
+
+    // maps the file rather than reading it, so only the parts looked at are loaded
+    int fd = open(replay_file, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0 || st.st_size == 0) {
+        fprintf(stderr, "%s: could not read %s\n", argv[0], replay_file);
+        return 1;
+    }
+    const uint8_t *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    Replay replay;
+    if (data == MAP_FAILED || !get_replay_functions()->open(&replay, data, st.st_size)) {
+        fprintf(stderr, "%s: %s is not a replay file\n", argv[0], replay_file);
+        return 1;
+    }
+
+    printf("deal %" PRIu64 ", %" PRIu32 " moves, %" PRIu32 " keyframes every %u moves, %zu bytes",
+           replay.deal_number, replay.num_moves, replay.num_keyframes, replay.keyframe_interval, replay.size);
+    if (replay.num_moves) {
+        printf(" (%.1f per move)", (double)replay.size / replay.num_moves);
+    }
+    printf("\n");
+
+    int status = 0;
+    if (move_number != NO_MOVE && !show_move(&replay, move_number)) {
+        fprintf(stderr, "%s: could not go to move %" PRIu32 "\n", argv[0], move_number);
+        status = 1;
+    }
+    if (check && !check_replay(&replay)) {
+        status = 1;
+    }
+    munmap((void *)data, st.st_size);
+    return status;
+}
+
+// reads the command line options. Returns false if they are not valid.
+bool parse_args(int argc, char *argv[], const char **replay_file, uint32_t *move_number, bool *check) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--move") == 0 && i+1 < argc) {
+            char *end;
+            *move_number = strtoul(argv[++i], &end, 10);
+            if (*end != '\0' || *move_number == NO_MOVE) {
+                return false;
+            }
+        } else if (strcmp(argv[i], "--check") == 0) {
+            *check = true;
+        } else if (*replay_file == NULL && argv[i][0] != '-') {
+            *replay_file = argv[i];
+        } else {
+            return false;
+        }
+    }
+    return *replay_file != NULL;
+}
+
+// draws the position after a number of moves, along with the move that led to
+// it. Returns false if the replay has fewer moves.
+bool show_move(const Replay *replay, uint32_t move_number) {
+    const MemoryRenderFunctions *mfuncs = get_memory_render_functions();
+    Board board;
+    if (!get_replay_functions()->seek(replay, move_number, &board) || !mfuncs->init(REPLAY_LINES, REPLAY_COLS)) {
+        return false;
+    }
+    GameState state = { .spot = NO_SPOT, .index = 0, .saved_spot = NO_SPOT, .saved_index = 0,
+                        .help_menu_up = false, .latency_hud_up = false,
+                        .hint_up = false, .hint_from = NO_SPOT, .hint_to = NO_SPOT, .hint_index = 0, .winnable = WINNABLE_NONE, .dirty = DIRTY_SCREEN };
+    Screen screen = { .cells_written = 0, .total_cells_written = 0, .frames = 0 };
+    get_draw_functions()->set_backend(mfuncs->backend);
+    get_draw_functions()->screen(&board, &state, &screen);
+    mfuncs->write(stdout, false);
+    mfuncs->free();
+
+    printf("move %" PRIu32 " of %" PRIu32, move_number, replay->num_moves);
+    JournalEntry entry;
+    if (move_number > 0 && get_replay_functions()->move(replay, move_number-1, &entry)) {
+        printf(": ");
+        print_entry(entry);
+    }
+    printf("\n");
+    return true;
+}
+
+// prints a move record
+void print_entry(JournalEntry entry) {
+    if (entry.flags & JOURNAL_FLIP) {
+        printf("flip");
+    } else {
+        printf("%s to %s", spot_names[entry.from], spot_names[entry.to]);
+        if (entry.num_cards > 1) {
+            printf(", %u cards", entry.num_cards);
+        }
+    }
+}
+
+// returns whether two boards hold the same position
+static bool same_position(const Board *a, const Board *b) {
+    const PackedFunctions *pfuncs = get_packed_functions();
+    PackedBoard packed_a = pfuncs->pack(a), packed_b = pfuncs->pack(b);
+    return memcmp(&packed_a, &packed_b, sizeof(PackedBoard)) == 0;
+}
+// plays the whole replay from the deal, checking that seeking to every move
+// gives the same position, and compares the time seeking takes with the time
+// replaying from the deal takes. Returns false if a position differs.
+bool check_replay(const Replay *replay) {
+    const ReplayFunctions *rfuncs = get_replay_functions();
+    const LatencyFunctions *lfuncs = get_latency_functions();
+
+    Board board = get_board_functions()->fresh_board(), seeked;
+    get_board_functions()->deal(&board, replay->deal_number);
+    uint64_t seek_ns = 0, from_deal_ns = 0;
+    for (uint32_t i = 0; i <= replay->num_moves; i++) {
+        uint64_t start = lfuncs->now();
+        bool found = rfuncs->seek(replay, i, &seeked);
+        seek_ns += lfuncs->now() - start;
+        if (!found || !same_position(&board, &seeked)) {
+            fprintf(stderr, "position after move %" PRIu32 " differs\n", i);
+            return false;
+        }
+
+        // the time to get here without keyframes: deal, then play every move
+        start = lfuncs->now();
+        Board replayed = get_board_functions()->fresh_board();
+        get_board_functions()->deal(&replayed, replay->deal_number);
+        for (uint32_t j = 0; j < i; j++) {
+            JournalEntry entry;
+            rfuncs->move(replay, j, &entry);
+            get_board_functions()->apply_move(&replayed, get_journal_functions()->entry_move(&replayed, entry));
+        }
+        from_deal_ns += lfuncs->now() - start;
+
+        JournalEntry entry;
+        if (i < replay->num_moves && (!rfuncs->move(replay, i, &entry)
+            || !get_board_functions()->apply_move(&board, get_journal_functions()->entry_move(&board, entry)))) {
+            fprintf(stderr, "move %" PRIu32 " is not legal\n", i+1);
+            return false;
+        }
+    }
+    printf("all %" PRIu32 " positions match\n", replay->num_moves + 1);
+    printf("seek from keyframe %8.1f ns/position\n", (double)seek_ns / (replay->num_moves + 1));
+    printf("replay from deal   %8.1f ns/position\n", (double)from_deal_ns / (replay->num_moves + 1));
+    return true;
+}
@@ -0,0 +1,30 @@
+#ifndef __RULES_H__
+#define __RULES_H__
+#include <stdbool.h>
+
+// The rule variant is picked when the game is built, e.g.
+// "make DRAW_COUNT=3 PASS_LIMIT=3", so the rules are compiled for just that
+// variant and never check which one is being played.
+
+// how many cards a flip turns over from the deck onto the discard pile
+#ifndef DRAW_COUNT
+#define DRAW_COUNT 1
+#endif
+
+// how many times the deck may be gone through, or 0 for no limit
+#ifndef PASS_LIMIT
+#define PASS_LIMIT 0
+#endif
+
+_Static_assert(DRAW_COUNT >= 1 && DRAW_COUNT <= 24, "a flip turns over from 1 to 24 cards");
+_Static_assert(PASS_LIMIT >= 0 && PASS_LIMIT <= 255, "the pass limit is kept in a byte");
+
+// whether or not the discard pile can be turned back into the deck after
+// "passes" times through it
+#if PASS_LIMIT
+#define CAN_RECYCLE(passes) ((passes) + 1 < PASS_LIMIT)
+#else
+#define CAN_RECYCLE(passes) true
+#endif
+
+#endif /* __RULES_H__ */
@@ -0,0 +1,153 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Card.h"
+#include "Policy.h"
+#include "Simulator.h"
+
+// the options for one run of the simulator
+typedef struct {
+    uint64_t first_deal;
+    uint64_t num_games;
+    unsigned int max_moves;
+    unsigned int num_threads;
+    const Policy *policy;
+} SimOptions;
+
+// one thread's stream of games: every "stride"th deal from "first_deal", and
+// the totals over them
+typedef struct {
+    const SimOptions *options;
+    uint64_t first_deal;
+    uint64_t num_games;
+    unsigned int stride;
+    uint64_t wins;
+    uint64_t moves;
+    uint64_t solution_cards;
+} SimStream;
+
+bool parse_args(int argc, char *argv[], SimOptions *options);
+void *run_stream(void *stream);
+void print_usage(const char *name);
+
+int main(int argc, char *argv[]) {
+    SimOptions options = { 1, 1000, 1000, 1, get_policy_functions()->find("greedy") };
+    options.num_threads = sysconf(_SC_NPROCESSORS_ONLN) > 0 ? sysconf(_SC_NPROCESSORS_ONLN) : 1;
+    if (!parse_args(argc, argv, &options)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (options.num_threads > options.num_games) {
+        options.num_threads = options.num_games > 0 ? options.num_games : 1;
+    }
+
+    SimStream *streams = calloc(options.num_threads, sizeof(SimStream));
+    pthread_t *threads = calloc(options.num_threads, sizeof(pthread_t));
+    if (streams == NULL || threads == NULL) {
+        fprintf(stderr, "%s: out of memory\n", argv[0]);
+        return 1;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned int i = 0; i < options.num_threads; i++) {
+        streams[i].options = &options;
+        streams[i].first_deal = options.first_deal + i;
+        streams[i].num_games = options.num_games / options.num_threads + (i < options.num_games % options.num_threads);
+        streams[i].stride = options.num_threads;
+        // the calling thread plays the first stream itself
+        if (i > 0 && pthread_create(&threads[i], NULL, run_stream, &streams[i]) != 0) {
+            fprintf(stderr, "%s: could not start a thread\n", argv[0]);
+            return 1;
+        }
+    }
+    run_stream(&streams[0]);
+
+    uint64_t wins = streams[0].wins, moves = streams[0].moves, solution_cards = streams[0].solution_cards;
+    for (unsigned int i = 1; i < options.num_threads; i++) {
+        pthread_join(threads[i], NULL);
+        wins += streams[i].wins;
+        moves += streams[i].moves;
+        solution_cards += streams[i].solution_cards;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    double games = options.num_games > 0 ? options.num_games : 1;
+
+    printf("policy          %s\n", options.policy->name);
+    printf("deals           %" PRIu64 " to %" PRIu64 "\n", options.first_deal, options.first_deal + options.num_games - 1);
+    printf("games           %" PRIu64 "\n", options.num_games);
+    printf("wins            %" PRIu64 " (%.2f%%)\n", wins, 100.0 * wins / games);
+    printf("average moves   %.1f\n", moves / games);
+    printf("average cards   %.2f of %d on solution stacks\n", solution_cards / games, NUM_SUITS * NUM_VALUES);
+    printf("time            %.3f s on %u thread%s (%.0f games/s)\n", seconds, options.num_threads, options.num_threads == 1 ? "" : "s",
+           seconds > 0 ? options.num_games / seconds : 0.0);
+
+    free(streams);
+    free(threads);
+    return 0;
+}
+
+// plays every game of one stream, adding up the results
+void *run_stream(void *arg) {
+    SimStream *stream = arg;
+    const SimulatorFunctions *sfuncs = get_simulator_functions();
+    for (uint64_t i = 0; i < stream->num_games; i++) {
+        GameResult result = sfuncs->play(stream->first_deal + i * stream->stride, stream->options->policy, stream->options->max_moves);
+        stream->wins += result.won;
+        stream->moves += result.num_moves;
+        stream->solution_cards += result.solution_cards;
+    }
+    return NULL;
+}
+
+// reads the command line options. Returns false if they are not valid.
+bool parse_args(int argc, char *argv[], SimOptions *options) {
+    for (int i = 1; i < argc; i++) {
+        char *end = "";
+        if (i+1 >= argc) {
+            return false;
+        }
+        if (strcmp(argv[i], "--first-deal") == 0) {
+            options->first_deal = strtoull(argv[++i], &end, 10);
+        } else if (strcmp(argv[i], "--games") == 0) {
+            options->num_games = strtoull(argv[++i], &end, 10);
+        } else if (strcmp(argv[i], "--max-moves") == 0) {
+            options->max_moves = strtoul(argv[++i], &end, 10);
+        } else if (strcmp(argv[i], "--threads") == 0) {
+            options->num_threads = strtoul(argv[++i], &end, 10);
+            if (options->num_threads == 0) {
+                return false;
+            }
+        } else if (strcmp(argv[i], "--policy") == 0) {
+            options->policy = get_policy_functions()->find(argv[++i]);
+            if (options->policy == NULL) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+        if (*end != '\0') {
+            return false;
+        }
+    }
+    return true;
+}
+
+// prints how to run the simulator, with the policies it knows
+void print_usage(const char *name) {
+    unsigned int num_policies;
+    const Policy *policies = get_policy_functions()->all(&num_policies);
+    fprintf(stderr, "usage: %s [--policy NAME] [--first-deal N] [--games N] [--max-moves N] [--threads N]\n", name);
+    fprintf(stderr, "policies:\n");
+    for (unsigned int i = 0; i < num_policies; i++) {
+        fprintf(stderr, "  %-10s %s\n", policies[i].name, policies[i].description);
+    }
+}
@@ -0,0 +1,104 @@
+#include "Simulator.h"
+#include "Board.h"
+#include "MoveGen.h"
+#include "Packed.h"
+#include "Policy.h"
+#include "Random.h"
+
+GameResult play_game(uint64_t deal_number, const Policy *policy, unsigned int max_moves);
+GameResult record_game(uint64_t deal_number, const Policy *policy, unsigned int max_moves, Board *positions, Move *moves);
+static GameResult run_game(uint64_t deal_number, const Policy *policy, unsigned int max_moves, Board *positions, Move *played);
+
+const SimulatorFunctions simulator_functions = {
+    .play=play_game,
+    .record=record_game
+};
+
+// returns pointer to the handler for simulator functions
+const SimulatorFunctions *get_simulator_functions() {
+    return &simulator_functions;
+}
+
+// returns the number of cards on solution stacks
+static unsigned int count_solution_cards(const PackedBoard *packed) {
+    unsigned int n = 0;
+    for (int i = 0; i < NUM_SOLUTION_STACKS; i++) {
+        n += packed->solution[i] & PACKED_SOLUTION_COUNT_MASK;
+    }
+    return n;
+}
+// returns the number of face down cards in the working stacks
+static unsigned int count_face_down(const PackedBoard *packed) {
+    unsigned int n = 0;
+    unsigned int start = packed->num_cards[PACKED_DECK] + packed->num_cards[PACKED_DISCARD];
+    for (int i = 0; i < NUM_WORKING_STACKS; i++) {
+        unsigned int end = start + packed->num_cards[PACKED_WORKING_0+i];
+        for (unsigned int j = start; j < end; j++) {
+            if (!(packed->cards[j] & PACKED_VISIBLE)) {
+                n++;
+            }
+        }
+        start = end;
+    }
+    return n;
+}
+
+// deals the given game and plays it with "policy" until it is won, no moves
+// are left, "max_moves" moves have been played (0 for no limit) or it stalls.
+// The policy's random choices are seeded from the deal number, so a game
+// always plays out the same way.
+GameResult play_game(uint64_t deal_number, const Policy *policy, unsigned int max_moves) {
+    return run_game(deal_number, policy, max_moves, NULL, NULL);
+}
+// plays a game like play_game, keeping every position and move along the way:
+// "positions" gets the position before each move and the final one, so it must
+// have room for max_moves+1 boards, and "moves" for max_moves moves. There is
+// no unlimited game here, so max_moves must not be 0.
+GameResult record_game(uint64_t deal_number, const Policy *policy, unsigned int max_moves, Board *positions, Move *moves) {
+    return run_game(deal_number, policy, max_moves, positions, moves);
+}
+
+// plays a game, recording it if "positions" is not NULL
+static GameResult run_game(uint64_t deal_number, const Policy *policy, unsigned int max_moves, Board *positions, Move *played) {
+    const PackedFunctions *pfuncs = get_packed_functions();
+    const MoveGenFunctions *mgfuncs = get_move_gen_functions();
+    const RandomFunctions *rfuncs = get_random_functions();
+
+    Board board = get_board_functions()->fresh_board();
+    get_board_functions()->deal(&board, deal_number);
+    PackedBoard packed = pfuncs->pack(&board);
+    Rng rng;
+    rfuncs->seed(&rng, deal_number ^ 0x5eed5eed5eed5eedULL);
+
+    GameResult result = { false, 0, 0 };
+    unsigned int best_solution = 0, best_face_down = count_face_down(&packed), stalled = 0;
+    Move moves[MAX_MOVES];
+    while (!pfuncs->is_won(&packed) && (max_moves == 0 || result.num_moves < max_moves) && stalled < SIMULATOR_STALL_LIMIT) {
+        unsigned int num_moves = mgfuncs->generate(&packed, moves);
+        if (num_moves == 0) {
+            break;
+        }
+        Move move = moves[policy->choose(&packed, moves, num_moves, &rng)];
+        if (positions) {
+            positions[result.num_moves] = pfuncs->unpack(&packed);
+            played[result.num_moves] = move;
+        }
+        pfuncs->apply_move(&packed, move);
+        result.num_moves++;
+
+        unsigned int solution = count_solution_cards(&packed), face_down = count_face_down(&packed);
+        if (solution > best_solution || face_down < best_face_down) {
+            best_solution = solution > best_solution ? solution : best_solution;
+            best_face_down = face_down < best_face_down ? face_down : best_face_down;
+            stalled = 0;
+        } else {
+            stalled++;
+        }
+    }
+    if (positions) {
+        positions[result.num_moves] = pfuncs->unpack(&packed);
+    }
+    result.won = pfuncs->is_won(&packed);
+    result.solution_cards = count_solution_cards(&packed);
+    return result;
+}
@@ -0,0 +1,27 @@
+#ifndef __SIMULATOR_H__
+#define __SIMULATOR_H__
+#include <stdbool.h>
+#include <stdint.h>
+#include "Board.h"
+#include "Policy.h"
+
+// a game ends once this many moves go by without a card reaching a solution
+// stack or a face down card being turned over
+#define SIMULATOR_STALL_LIMIT 250
+
+// how one simulated game went
+typedef struct {
+    bool won;
+    unsigned int num_moves;
+    unsigned int solution_cards;
+} GameResult;
+
+// handler struct for playing whole games with a policy
+typedef struct {
+    GameResult (*play)(uint64_t deal_number, const Policy *, unsigned int max_moves);
+    GameResult (*record)(uint64_t deal_number, const Policy *, unsigned int max_moves, Board *positions, Move *moves);
+} SimulatorFunctions;
+
+const SimulatorFunctions *get_simulator_functions();
+
+#endif /* __SIMULATOR_H__ */
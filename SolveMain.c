@@ -0,0 +1,153 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <unistd.h>
+
+#include "Board.h"
+#include "Card.h"
+#include "Packed.h"
+#include "Solver.h"
+
+bool parse_args(int argc, char *argv[], uint64_t *deal_number, const char **position_file, SolverOptions *options);
+bool read_position(const char *path, PackedBoard *packed);
+void print_move(const Board *board, Move move, unsigned int number);
+const char *spot_name(SELECTED_SPOT spot);
+
+int main(int argc, char *argv[]) {
+    const BoardFunctions  *bfuncs = get_board_functions();
+    const PackedFunctions *pfuncs = get_packed_functions();
+    const SolverFunctions *sfuncs = get_solver_functions();
+
+    uint64_t deal_number = 0;
+    const char *position_file = NULL;
+    SolverOptions options = sfuncs->default_options();
+    options.num_threads = sysconf(_SC_NPROCESSORS_ONLN) > 0 ? sysconf(_SC_NPROCESSORS_ONLN) : 1;
+    if (!parse_args(argc, argv, &deal_number, &position_file, &options)) {
+        fprintf(stderr, "usage: %s [--deal N | --position FILE] [--max-nodes N] [--max-ms N] [--table-bits N] [--threads N]\n", argv[0]);
+        return 1;
+    }
+
+    PackedBoard packed;
+    if (position_file) {
+        if (!read_position(position_file, &packed)) {
+            fprintf(stderr, "%s: could not read a position from %s\n", argv[0], position_file);
+            return 1;
+        }
+    } else {
+        Board board = bfuncs->fresh_board();
+        bfuncs->deal(&board, deal_number);
+        packed = pfuncs->pack(&board);
+    }
+
+    Move *line = malloc(sizeof(Move) * MAX_SOLUTION_LENGTH);
+    if (line == NULL) {
+        fprintf(stderr, "%s: out of memory\n", argv[0]);
+        return 1;
+    }
+    SolverResult result = sfuncs->solve(&packed, options, line);
+
+    switch (result.result) {
+        case SOLVE_WON:
+        {
+            printf("winnable in %u moves (%lu positions searched)\n", result.num_moves, result.nodes);
+            // replays the line with the rules of the game itself, so it is known to be playable
+            Board board = pfuncs->unpack(&packed);
+            for (unsigned int i = 0; i < result.num_moves; i++) {
+                print_move(&board, line[i], i+1);
+                if (!bfuncs->apply_move(&board, line[i])) {
+                    fprintf(stderr, "%s: move %u is not legal\n", argv[0], i+1);
+                    return 1;
+                }
+            }
+            break;
+        }
+        case SOLVE_LOST:
+            printf("unwinnable (%lu positions searched)\n", result.nodes);
+            break;
+        default:
+            printf("unknown, search limit reached (%lu positions searched)\n", result.nodes);
+            break;
+    }
+    printf("peak memory %.1f MB\n", result.peak_bytes / (1024.0 * 1024.0));
+    free(line);
+    return 0;
+}
+
+// reads the command line options. Returns false if they are not valid.
+bool parse_args(int argc, char *argv[], uint64_t *deal_number, const char **position_file, SolverOptions *options) {
+    for (int i = 1; i < argc; i++) {
+        char *end = "";
+        if (i+1 >= argc) {
+            return false;
+        }
+        if (strcmp(argv[i], "--deal") == 0) {
+            *deal_number = strtoull(argv[++i], &end, 10);
+        } else if (strcmp(argv[i], "--position") == 0) {
+            *position_file = argv[++i];
+        } else if (strcmp(argv[i], "--max-nodes") == 0) {
+            options->max_nodes = strtoul(argv[++i], &end, 10);
+        } else if (strcmp(argv[i], "--max-ms") == 0) {
+            options->max_ms = strtoul(argv[++i], &end, 10);
+        } else if (strcmp(argv[i], "--table-bits") == 0) {
+            options->trans_table_bits = strtoul(argv[++i], &end, 10);
+            if (options->trans_table_bits < 10 || options->trans_table_bits > 34) {
+                return false;
+            }
+        } else if (strcmp(argv[i], "--threads") == 0) {
+            options->num_threads = strtoul(argv[++i], &end, 10);
+            if (options->num_threads == 0) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+        if (*end != '\0') {
+            return false;
+        }
+    }
+    return true;
+}
+
+// reads a saved position: a PackedBoard as raw bytes. Returns false on failure,
+// or if the bytes are not a position that can be played.
+bool read_position(const char *path, PackedBoard *packed) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        return false;
+    }
+    bool ok = fread(packed, sizeof(PackedBoard), 1, file) == 1;
+    fclose(file);
+    return ok && get_packed_functions()->is_valid(packed);
+}
+
+// prints a move of the winning line, naming the card that moves
+void print_move(const Board *board, Move move, unsigned int number) {
+    const CardFunctions   *cfuncs = get_card_functions();
+    if (move.type == MOVE_FLIP) {
+        printf("%4u: flip\n", number);
+        return;
+    }
+    Card card;
+    if (move.from == DECK_STACK) {
+        card = board->deck.discard[board->deck.num_cards_discard-1];
+    } else if (move.from >= SOLUTION_0 && move.from <= SOLUTION_3) {
+        card = stack_top(&board->solution_stacks[move.from-SOLUTION_0]);
+    } else {
+        card = board->working_stacks[move.from-WORKING_0].cards[move.index];
+    }
+    printf("%4u: %2s%c %s -> %s\n", number, cfuncs->value_string(card.value), "SDCH"[card.suit],
+            spot_name(move.from), spot_name(move.to));
+}
+
+// returns a readable name for a spot on the board
+const char *spot_name(SELECTED_SPOT spot) {
+    static const char *names[] = {
+        "solution 0", "solution 1", "solution 2", "solution 3",
+        "working 0", "working 1", "working 2", "working 3", "working 4", "working 5", "working 6",
+        "discard", "none"
+    };
+    return names[spot];
+}
@@ -0,0 +1,637 @@
+#include "Solver.h"
+#include "Arena.h"
+#include "Board.h"
+#include "Latency.h"
+#include "MoveGen.h"
+#include "Packed.h"
+#include "TransTable.h"
+#include "Zobrist.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+SolverOptions default_solver_options(void);
+SolverResult solve(const PackedBoard *, SolverOptions, Move *line);
+
+const SolverFunctions solver_functions = {
+    .default_options=default_solver_options,
+    .solve=solve
+};
+
+// a step of the search in four bytes: a move of cards, made after flipping
+// the deck "flips" times
+typedef struct {
+    uint8_t from;
+    uint8_t to;
+    uint8_t index;
+    uint8_t flips;
+} SearchMove;
+
+// room for every generated move plus a draw of each card in the deck
+#define MAX_SEARCH_MOVES (MAX_MOVES + NUM_CARDS * (1 + NUM_WORKING_STACKS))
+
+// a position on the search path, with its moves in the order they are tried
+typedef struct {
+    PackedBoard board;
+    SearchMove moves[MAX_SEARCH_MOVES];
+    unsigned int num_moves;
+    unsigned int next_move;
+} SearchFrame;
+
+// a subtree still to be searched: a position, and the moves that reach it
+// from the start of the search
+typedef struct {
+    PackedBoard board;
+    unsigned int depth;
+    SearchMove path[MAX_SEARCH_DEPTH];
+} SearchTask;
+
+// number of subtrees each worker can queue up
+#define TASK_QUEUE_SIZE 32
+// how many positions a worker searches before adding them to the shared count
+#define NODE_BATCH 1024
+
+// a worker's queue of subtrees. The worker takes the newest from the back,
+// idle workers steal the oldest, and so biggest, from the front.
+typedef struct {
+    pthread_mutex_t lock;
+    SearchTask *tasks;
+    unsigned int head;
+    atomic_uint count;
+} TaskQueue;
+
+typedef struct Worker Worker;
+
+// state shared by all the workers of one search
+typedef struct {
+    SolverOptions options;
+    TransTable table;
+    Worker *workers;
+    atomic_long pending_tasks;  // queued or being searched
+    atomic_int idle_workers;
+    atomic_ulong nodes;
+    atomic_bool done;           // a win was found or the node limit reached
+    atomic_bool hit_limit;
+    uint64_t deadline_ns;       // when the time limit runs out, 0 for none
+    pthread_mutex_t line_lock;
+    Move *line;
+    unsigned int num_moves;
+    bool won;
+} SharedSearch;
+
+// a search thread, with its own queue and search path
+struct Worker {
+    SharedSearch *shared;
+    unsigned int id;
+    pthread_t thread;
+    TaskQueue queue;
+    SearchTask task;
+    SearchFrame *frames;
+    SearchTask *spare_task;   // where the subtrees it hands out are built
+    unsigned long nodes;
+};
+
+// returns pointer to the handler for solver functions
+const SolverFunctions *get_solver_functions() {
+    return &solver_functions;
+}
+
+// gives the options used when none are given: no node or time limit, a 32MB
+// table, one thread, no way to cancel and memory of its own
+SolverOptions default_solver_options(void) {
+    return (SolverOptions){ .max_nodes=0, .max_ms=0, .trans_table_bits=22, .num_threads=1, .cancel=NULL, .arena=NULL };
+}
+
+// returns the index of the first card of a working stack
+static unsigned int working_start(const PackedBoard *packed, int stack) {
+    unsigned int start = 0;
+    for (int i = 0; i < PACKED_WORKING_0 + stack; i++) {
+        start += packed->num_cards[i];
+    }
+    return start;
+}
+// returns whether or not a card can go straight onto a solution stack
+static bool fits_solution(const PackedBoard *packed, PackedCard card) {
+    unsigned int id = card & PACKED_ID_MASK;
+    for (int i = 0; i < NUM_SOLUTION_STACKS; i++) {
+        unsigned int count = packed->solution[i] & PACKED_SOLUTION_COUNT_MASK;
+        if (count == 0 ? id % NUM_VALUES == VALUE_ACE
+                : id == (packed->solution[i] >> PACKED_SOLUTION_SUIT_SHIFT) * NUM_VALUES + count) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// ranks a move for move ordering, lower first: solution moves, then moves that
+// turn over a card, then plays from the deck, then the rest. Returns -1 for
+// moves that can never help:
+//  - aces sent to any but the first empty solution stack, and kings sent to
+//    any but the first empty working stack
+//  - a whole working stack moved onto an empty one
+//  - part of a face up run moved when the card it uncovers can't go to a
+//    solution stack. The uncovered card has the same value and color as the
+//    card the run moves onto, so this only swaps two places that differ in
+//    suit. Those are taken as equivalent, which is not exact: the two cards
+//    go to different solution stacks, so in rare deals this can miss a win.
+static int move_rank(const PackedBoard *packed, Move move) {
+    if (move.to >= SOLUTION_0 && move.to <= SOLUTION_3) {
+        for (int i = 0; i < move.to - SOLUTION_0; i++) {
+            if (packed->solution[i] == 0 && packed->solution[move.to - SOLUTION_0] == 0) {
+                return -1;
+            }
+        }
+        return 0;
+    }
+    int to_segment = PACKED_WORKING_0 + move.to - WORKING_0;
+    if (packed->num_cards[to_segment] == 0) {
+        for (int i = PACKED_WORKING_0; i < to_segment; i++) {
+            if (packed->num_cards[i] == 0) {
+                return -1;
+            }
+        }
+    }
+    if (move.from == DECK_STACK) {
+        return 2;
+    }
+    if (move.from >= SOLUTION_0 && move.from <= SOLUTION_3) {
+        return 4;
+    }
+    if (move.index == 0) {
+        return packed->num_cards[to_segment] == 0 ? -1 : 3;
+    }
+    PackedCard under = packed->cards[working_start(packed, move.from - WORKING_0) + move.index - 1];
+    if (!(under & PACKED_VISIBLE)) {
+        return 1;
+    }
+    return fits_solution(packed, under) ? 1 : -1;
+}
+
+// adds a move to a frame, keeping the moves sorted by rank. Stable, so moves of
+// the same rank are tried in the order they were added.
+static void add_move(SearchFrame *frame, int *ranks, SearchMove move, int rank) {
+    unsigned int j = frame->num_moves++;
+    for (; j > 0 && ranks[j-1] > rank; j--) {
+        frame->moves[j] = frame->moves[j-1];
+        ranks[j] = ranks[j-1];
+    }
+    frame->moves[j] = move;
+    ranks[j] = rank;
+}
+
+// adds the moves of the card on top of the discard pile of a position reached
+// by flipping the deck "flips" times
+static void add_flip_moves(SearchFrame *frame, int *ranks, const PackedBoard *flipped,
+                           unsigned int flips, SELECTED_SPOT only_to) {
+    for (int to = SOLUTION_0; to <= WORKING_6; to++) {
+        Move move = { MOVE_CARDS, DECK_STACK, to, 0 };
+        if ((only_to != NO_SPOT && to != only_to) || !get_packed_functions()->is_legal(flipped, move)) {
+            continue;
+        }
+        int rank = move_rank(flipped, move);
+        if (rank >= 0) {
+            add_move(frame, ranks, (SearchMove){ DECK_STACK, to, 0, flips }, rank);
+        }
+    }
+}
+
+// returns the only stack worth moving onto after "previous", or NO_SPOT if any
+// move may help. A card only comes back down from a solution stack to have
+// another card put on it, so after that the only moves tried are ones onto it.
+static SELECTED_SPOT only_to_after(const Move *previous) {
+    if (previous && previous->from >= SOLUTION_0 && previous->from <= SOLUTION_3) {
+        return previous->to;
+    }
+    return NO_SPOT;
+}
+
+// fills in the moves of a frame's position. Flips are never tried on their
+// own: instead each card that can be reached by flipping and then played is a
+// single move. Flipping only ever cycles the deck through the same order, and
+// uses up passes when they are limited, so flipping without playing a card
+// never helps.
+// "previous" is the move that led to the position, if any, which may limit the
+// moves tried; see only_to_after.
+static void order_moves(SearchFrame *frame, const Move *previous) {
+    const PackedBoard *packed = &frame->board;
+    Move moves[MAX_MOVES];
+    int ranks[MAX_SEARCH_MOVES];
+    unsigned int n = get_move_gen_functions()->generate(packed, moves);
+    SELECTED_SPOT only_to = only_to_after(previous);
+    frame->num_moves = 0;
+    frame->next_move = 0;
+    for (unsigned int i = 0; i < n; i++) {
+        if (moves[i].type == MOVE_FLIP || (only_to != NO_SPOT && moves[i].to != only_to)) {
+            continue;
+        }
+        // a safe move to a solution stack is the only one worth trying
+        if (moves[i].to >= SOLUTION_0 && moves[i].to <= SOLUTION_3 && move_rank(packed, moves[i]) >= 0) {
+            unsigned int top = moves[i].from == DECK_STACK
+                ? packed->num_cards[PACKED_DECK] + packed->num_cards[PACKED_DISCARD] - 1
+                : working_start(packed, moves[i].from - WORKING_0) + moves[i].index;
+            if (get_packed_functions()->is_safe_for_solution(packed, packed->cards[top])) {
+                frame->moves[0] = (SearchMove){ moves[i].from, moves[i].to, moves[i].index, 0 };
+                frame->num_moves = 1;
+                return;
+            }
+        }
+        int rank = move_rank(packed, moves[i]);
+        if (rank >= 0) {
+            add_move(frame, ranks, (SearchMove){ moves[i].from, moves[i].to, moves[i].index, 0 }, rank);
+        }
+    }
+
+    uint64_t accepts = 0;
+    for (int i = 0; i < NUM_WORKING_STACKS; i++) {
+        unsigned int count = packed->num_cards[PACKED_WORKING_0+i];
+        accepts |= count
+            ? get_move_gen_functions()->stackable_on(packed->cards[working_start(packed, i) + count - 1])
+            : 0;
+    }
+#if DRAW_COUNT == 1
+    // the cards that come up in turn as the deck is flipped: the deck from the
+    // top down, then after recycling the discard pile from the bottom up, until
+    // the card on top now comes back up
+    unsigned int deck = packed->num_cards[PACKED_DECK];
+    unsigned int total = deck + packed->num_cards[PACKED_DISCARD];
+    unsigned int max_flips = !PACKED_CAN_RECYCLE(packed) ? deck
+                           : packed->num_cards[PACKED_DISCARD] ? total - 1 : total;
+    for (unsigned int flips = 1; flips <= max_flips; flips++) {
+        PackedCard card = flips <= deck ? packed->cards[deck - flips] : packed->cards[flips - 1];
+        unsigned int id = card & PACKED_ID_MASK;
+        bool to_solution = fits_solution(packed, card);
+        bool to_working = (accepts & (1ULL << id)) || id % NUM_VALUES == VALUE_KING;
+        if (!to_solution && !to_working) {
+            continue;
+        }
+        // work out the position after flipping to find the moves exactly
+        PackedBoard flipped = *packed;
+        for (unsigned int i = 0; i < flips; i++) {
+            get_packed_functions()->apply_move(&flipped, (Move){ .type=MOVE_FLIP });
+        }
+        add_flip_moves(frame, ranks, &flipped, flips, only_to);
+    }
+#else
+    // several cards come up at a time, so which card ends up on top is found
+    // by flipping a copy: to the end of the deck, then once recycled through
+    // all of it once more, after which the same cards come up again
+    PackedBoard flipped = *packed;
+    bool recycled = false;
+    for (unsigned int flips = 1; get_packed_functions()->is_legal(&flipped, (Move){ .type=MOVE_FLIP }); flips++) {
+        if (flipped.num_cards[PACKED_DECK] == 0) {
+            if (recycled) {
+                break;
+            }
+            recycled = true;
+        }
+        get_packed_functions()->apply_move(&flipped, (Move){ .type=MOVE_FLIP });
+        PackedCard card = flipped.cards[flipped.num_cards[PACKED_DECK] + flipped.num_cards[PACKED_DISCARD] - 1];
+        unsigned int id = card & PACKED_ID_MASK;
+        if (fits_solution(&flipped, card) || (accepts & (1ULL << id)) || id % NUM_VALUES == VALUE_KING) {
+            add_flip_moves(frame, ranks, &flipped, flips, only_to);
+        }
+    }
+#endif
+}
+
+// returns the move of cards a search move ends with
+static Move search_move_cards(SearchMove move) {
+    return (Move){ MOVE_CARDS, move.from, move.to, move.index };
+}
+// applies a search move to a board
+static void apply_search_move(PackedBoard *packed, SearchMove move) {
+    const PackedFunctions *pfuncs = get_packed_functions();
+    for (unsigned int i = 0; i < move.flips; i++) {
+        pfuncs->apply_move(packed, (Move){ .type=MOVE_FLIP });
+    }
+    pfuncs->apply_move(packed, search_move_cards(move));
+}
+
+// copies a task, along with only as much of its path as is used
+static void copy_task(SearchTask *to, const SearchTask *from) {
+    to->board = from->board;
+    to->depth = from->depth;
+    memcpy(to->path, from->path, sizeof(SearchMove) * from->depth);
+}
+// adds a task to the back of a queue. Returns false if the queue is full.
+static bool push_task(TaskQueue *queue, const SearchTask *task) {
+    pthread_mutex_lock(&queue->lock);
+    unsigned int count = atomic_load_explicit(&queue->count, memory_order_relaxed);
+    bool pushed = count < TASK_QUEUE_SIZE;
+    if (pushed) {
+        copy_task(&queue->tasks[(queue->head + count) % TASK_QUEUE_SIZE], task);
+        atomic_store_explicit(&queue->count, count+1, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return pushed;
+}
+// takes a task from the back of a queue, or from the front when stealing.
+// Returns false if the queue is empty.
+static bool take_task(TaskQueue *queue, SearchTask *task, bool steal) {
+    if (atomic_load_explicit(&queue->count, memory_order_relaxed) == 0) {
+        return false;
+    }
+    pthread_mutex_lock(&queue->lock);
+    unsigned int count = atomic_load_explicit(&queue->count, memory_order_relaxed);
+    bool taken = count > 0;
+    if (taken) {
+        if (steal) {
+            copy_task(task, &queue->tasks[queue->head]);
+            queue->head = (queue->head + 1) % TASK_QUEUE_SIZE;
+        } else {
+            copy_task(task, &queue->tasks[(queue->head + count - 1) % TASK_QUEUE_SIZE]);
+        }
+        atomic_store_explicit(&queue->count, count-1, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return taken;
+}
+
+// hands the untried moves of the shallowest unfinished frame over to the
+// worker's queue as tasks, for idle workers to steal
+static void donate_moves(Worker *worker, int depth) {
+    SharedSearch *shared = worker->shared;
+    SearchFrame *frames = worker->frames;
+    int shallowest = 0;
+    while (shallowest < depth && frames[shallowest].next_move == frames[shallowest].num_moves) {
+        shallowest++;
+    }
+    SearchFrame *frame = &frames[shallowest];
+    if (frame->next_move == frame->num_moves) {
+        return;
+    }
+
+    SearchTask *task = worker->spare_task;
+    copy_task(task, &worker->task);
+    for (int i = 0; i < shallowest; i++) {
+        task->path[task->depth++] = frames[i].moves[frames[i].next_move-1];
+    }
+    // donates the lowest ranked moves, leaving the best ones to this worker
+    while (frame->num_moves > frame->next_move) {
+        SearchMove move = frame->moves[frame->num_moves-1];
+        task->board = frame->board;
+        apply_search_move(&task->board, move);
+        task->path[task->depth] = move;
+        task->depth++;
+        atomic_fetch_add(&shared->pending_tasks, 1);
+        bool pushed = push_task(&worker->queue, task);
+        task->depth--;
+        if (!pushed) {
+            atomic_fetch_sub(&shared->pending_tasks, 1);
+            break;
+        }
+        frame->num_moves--;
+    }
+}
+
+// adds the worker's recently searched positions to the shared count, and
+// stops the search if that reaches the node limit, the time runs out or the
+// search was cancelled
+static void count_nodes(Worker *worker) {
+    SharedSearch *shared = worker->shared;
+    unsigned long nodes = atomic_fetch_add(&shared->nodes, worker->nodes) + worker->nodes;
+    worker->nodes = 0;
+    if ((shared->options.max_nodes && nodes >= shared->options.max_nodes)
+        || (shared->deadline_ns && get_latency_functions()->now() >= shared->deadline_ns)
+        || (shared->options.cancel && atomic_load(shared->options.cancel))) {
+        atomic_store(&shared->hit_limit, true);
+        atomic_store(&shared->done, true);
+    }
+}
+
+// writes out the winning line through "depth" frames of the worker's search,
+// unless another worker got there first
+static void record_win(Worker *worker, int depth) {
+    SharedSearch *shared = worker->shared;
+    pthread_mutex_lock(&shared->line_lock);
+    if (!shared->won) {
+        shared->won = true;
+        shared->num_moves = 0;
+        for (unsigned int i = 0; i < worker->task.depth + depth; i++) {
+            SearchMove move = i < worker->task.depth
+                ? worker->task.path[i]
+                : worker->frames[i - worker->task.depth].moves[worker->frames[i - worker->task.depth].next_move-1];
+            for (unsigned int j = 0; j < move.flips; j++) {
+                shared->line[shared->num_moves++] = (Move){ .type=MOVE_FLIP };
+            }
+            shared->line[shared->num_moves++] = search_move_cards(move);
+        }
+    }
+    pthread_mutex_unlock(&shared->line_lock);
+    atomic_store(&shared->done, true);
+}
+
+// searches the subtree of the worker's current task depth first, skipping
+// any position that any worker already searched. A position whose moves were
+// limited by the move that led to it is not searched in full, so it is never
+// put in the table, where it would stop the same position being searched in
+// full when it is reached another way.
+static void search_task(Worker *worker) {
+    const PackedFunctions     *pfuncs = get_packed_functions();
+    const TransTableFunctions *tfuncs = get_trans_table_functions();
+    const ZobristFunctions    *zfuncs = get_zobrist_functions();
+    SharedSearch *shared = worker->shared;
+    SearchFrame *frames = worker->frames;
+    SearchTask *task = &worker->task;
+
+    Move previous = task->depth ? search_move_cards(task->path[task->depth-1]) : (Move){ .type=MOVE_FLIP };
+    if (only_to_after(&previous) == NO_SPOT && !tfuncs->insert(&shared->table, zfuncs->canonical_hash(&task->board))) {
+        return;
+    }
+    worker->nodes++;
+    frames[0].board = task->board;
+    if (task->depth < MAX_SEARCH_DEPTH) {
+        order_moves(&frames[0], task->depth ? &previous : NULL);
+    } else {
+        frames[0].num_moves = frames[0].next_move = 0;
+        atomic_store(&shared->hit_limit, true);
+    }
+
+    int depth = 0;
+    while (depth >= 0 && !atomic_load_explicit(&shared->done, memory_order_relaxed)) {
+        SearchFrame *frame = &frames[depth];
+        if (pfuncs->is_won(&frame->board)) {
+            record_win(worker, depth);
+            break;
+        }
+        if (frame->next_move == frame->num_moves) {
+            depth--;
+            continue;
+        }
+        if (worker->nodes >= NODE_BATCH) {
+            count_nodes(worker);
+        }
+        if (atomic_load_explicit(&shared->idle_workers, memory_order_relaxed) > 0
+                && atomic_load_explicit(&worker->queue.count, memory_order_relaxed) == 0) {
+            donate_moves(worker, depth);
+            // the current frame may have given away all of its moves
+            continue;
+        }
+
+        SearchFrame *child = &frames[depth+1];
+        SearchMove move = frame->moves[frame->next_move++];
+        child->board = frame->board;
+        apply_search_move(&child->board, move);
+        Move cards = search_move_cards(move);
+        if (only_to_after(&cards) == NO_SPOT && !tfuncs->insert(&shared->table, zfuncs->canonical_hash(&child->board))) {
+            continue;
+        }
+        worker->nodes++;
+        if (task->depth + depth+1 < MAX_SEARCH_DEPTH) {
+            order_moves(child, &cards);
+        } else {
+            // too deep to search further, but still checked for a win
+            child->num_moves = child->next_move = 0;
+            atomic_store(&shared->hit_limit, true);
+        }
+        depth++;
+    }
+    count_nodes(worker);
+}
+
+// takes tasks from the worker's own queue, or steals them from the others,
+// and searches them until none are left anywhere or the search is done
+static void *run_worker(void *arg) {
+    Worker *worker = arg;
+    SharedSearch *shared = worker->shared;
+    unsigned int num_workers = shared->options.num_threads;
+    bool idle = false;
+    while (!atomic_load(&shared->done) && atomic_load(&shared->pending_tasks) > 0) {
+        bool found = take_task(&worker->queue, &worker->task, false);
+        for (unsigned int i = 1; !found && i < num_workers; i++) {
+            found = take_task(&shared->workers[(worker->id + i) % num_workers].queue, &worker->task, true);
+        }
+        if (!found) {
+            if (!idle) {
+                atomic_fetch_add(&shared->idle_workers, 1);
+                idle = true;
+            }
+            sched_yield();
+            continue;
+        }
+        if (idle) {
+            atomic_fetch_sub(&shared->idle_workers, 1);
+            idle = false;
+        }
+        search_task(worker);
+        atomic_fetch_sub(&shared->pending_tasks, 1);
+    }
+    if (idle) {
+        atomic_fetch_sub(&shared->idle_workers, 1);
+    }
+    return NULL;
+}
+
+// returns how much memory a search takes from its arena: the transposition
+// table, then the workers, and for each its queue, search path and spare task
+static size_t search_size(const SolverOptions *options) {
+    size_t per_worker = ARENA_ROUND(sizeof(SearchTask) * TASK_QUEUE_SIZE)
+                      + ARENA_ROUND(sizeof(SearchFrame) * (MAX_SEARCH_DEPTH+1))
+                      + ARENA_ROUND(sizeof(SearchTask));
+    return ARENA_ROUND(sizeof(uint64_t) << options->trans_table_bits)
+         + ARENA_ROUND(sizeof(Worker) * options->num_threads)
+         + per_worker * options->num_threads;
+}
+
+// takes the workers of a search and everything they use from the arena.
+// Returns false if it is full.
+static bool make_workers(SharedSearch *shared, Arena *arena) {
+    const ArenaFunctions *afuncs = get_arena_functions();
+    unsigned int num_workers = shared->options.num_threads;
+    if ((shared->workers = afuncs->alloc_zeroed(arena, sizeof(Worker) * num_workers)) == NULL) {
+        return false;
+    }
+    for (unsigned int i = 0; i < num_workers; i++) {
+        Worker *worker = &shared->workers[i];
+        worker->shared = shared;
+        worker->id = i;
+        worker->queue.tasks = afuncs->alloc(arena, sizeof(SearchTask) * TASK_QUEUE_SIZE);
+        worker->frames = afuncs->alloc(arena, sizeof(SearchFrame) * (MAX_SEARCH_DEPTH+1));
+        worker->spare_task = afuncs->alloc(arena, sizeof(SearchTask));
+        if (worker->queue.tasks == NULL || worker->frames == NULL || worker->spare_task == NULL) {
+            // undoes the workers already set up
+            while (i > 0) {
+                pthread_mutex_destroy(&shared->workers[--i].queue.lock);
+            }
+            return false;
+        }
+        pthread_mutex_init(&worker->queue.lock, NULL);
+        atomic_init(&worker->queue.count, 0);
+    }
+    return true;
+}
+
+// searches depth first for a line of moves that wins the game, skipping any
+// position that was already searched. The search tree is split between
+// options.num_threads workers, which steal subtrees from each other when they
+// run out of work. On a win the line, with every flip written out, goes into
+// "line", which must have room for MAX_SOLUTION_LENGTH moves.
+//
+// All the memory the search needs is taken from one arena before it starts,
+// so searching never allocates. Reusing an arena across searches saves
+// allocating even that.
+SolverResult solve(const PackedBoard *start, SolverOptions options, Move *line) {
+    const ArenaFunctions      *afuncs = get_arena_functions();
+    const TransTableFunctions *tfuncs = get_trans_table_functions();
+
+    SolverResult result = { .result=SOLVE_UNKNOWN, .num_moves=0, .nodes=0, .peak_bytes=0 };
+    if (options.num_threads == 0) {
+        options.num_threads = 1;
+    }
+    Arena own_arena = afuncs->fresh_arena();
+    Arena *arena = options.arena ? options.arena : &own_arena;
+    afuncs->reset(arena);
+    SharedSearch shared = { .options=options, .line=line, .num_moves=0, .won=false,
+                            .deadline_ns=options.max_ms ? get_latency_functions()->now() + options.max_ms * 1000000 : 0 };
+    atomic_init(&shared.pending_tasks, 1);
+    atomic_init(&shared.idle_workers, 0);
+    atomic_init(&shared.nodes, 0);
+    atomic_init(&shared.done, false);
+    atomic_init(&shared.hit_limit, false);
+    // the table goes first, so a fresh arena's memory is still zero for it
+    if (!afuncs->reserve(arena, search_size(&options))
+            || !tfuncs->init_in_arena(&shared.table, arena, options.trans_table_bits)
+            || !make_workers(&shared, arena)) {
+        afuncs->free(&own_arena);
+        return result;
+    }
+    unsigned int num_workers = options.num_threads;
+
+    // the whole search starts as one task for the first worker
+    pthread_mutex_init(&shared.line_lock, NULL);
+    shared.workers[0].task.board = *start;
+    shared.workers[0].task.depth = 0;
+    push_task(&shared.workers[0].queue, &shared.workers[0].task);
+    for (unsigned int i = 1; i < num_workers; i++) {
+        if (pthread_create(&shared.workers[i].thread, NULL, run_worker, &shared.workers[i]) != 0) {
+            // carries on with fewer threads; the others steal its share
+            shared.workers[i].thread = pthread_self();
+        }
+    }
+    run_worker(&shared.workers[0]);
+    for (unsigned int i = 1; i < num_workers; i++) {
+        if (!pthread_equal(shared.workers[i].thread, pthread_self())) {
+            pthread_join(shared.workers[i].thread, NULL);
+        }
+    }
+
+    result.nodes = atomic_load(&shared.nodes);
+    if (shared.won) {
+        result.result = SOLVE_WON;
+        result.num_moves = shared.num_moves;
+    } else {
+        result.result = atomic_load(&shared.hit_limit) ? SOLVE_UNKNOWN : SOLVE_LOST;
+    }
+    // nothing is given back to the arena during a search, so what it handed
+    // out is the most the search ever used
+    result.peak_bytes = arena->used;
+    pthread_mutex_destroy(&shared.line_lock);
+    for (unsigned int i = 0; i < num_workers; i++) {
+        pthread_mutex_destroy(&shared.workers[i].queue.lock);
+    }
+    afuncs->free(&own_arena);
+    return result;
+}
@@ -0,0 +1,44 @@
+#ifndef __SOLVER_H__
+#define __SOLVER_H__
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "Arena.h"
+#include "Board.h"
+#include "Packed.h"
+
+// deepest the solver searches. Drawing a card from the deck and playing it
+// counts as one step of the search, however many flips it takes.
+#define MAX_SEARCH_DEPTH 512
+// longest winning line, with every flip written out
+#define MAX_SOLUTION_LENGTH (MAX_SEARCH_DEPTH * NUM_CARDS)
+
+typedef enum { SOLVE_WON, SOLVE_LOST, SOLVE_UNKNOWN } SOLVE_RESULT;
+
+typedef struct {
+    unsigned long max_nodes;       // 0 for no limit
+    unsigned long max_ms;          // longest the search may run in milliseconds, 0 for no limit
+    unsigned int trans_table_bits; // log2 of the number of transposition table entries
+    unsigned int num_threads;      // workers searching in parallel
+    const atomic_bool *cancel;     // stops the search early once set, or NULL
+    Arena *arena;                  // memory for the search, reset and reused by each search
+                                   // given it, or NULL for the search to use its own
+} SolverOptions;
+
+typedef struct {
+    SOLVE_RESULT result;
+    unsigned int num_moves;        // length of the winning line
+    unsigned long nodes;           // positions searched
+    size_t peak_bytes;             // memory the search used, all taken before it started
+} SolverResult;
+
+// handler struct for the solver
+typedef struct {
+    SolverOptions (*default_options)(void);
+    SolverResult (*solve)(const PackedBoard *, SolverOptions, Move *line);
+} SolverFunctions;
+
+const SolverFunctions *get_solver_functions();
+
+#endif /* __SOLVER_H__ */
@@ -0,0 +1,426 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "Board.h"
+#include "Journal.h"
+#include "MoveGen.h"
+#include "Packed.h"
+#include "Policy.h"
+#include "Random.h"
+#include "Replay.h"
+#include "Zobrist.h"
+
+// the games the tests play: random moves on fixed deals
+#define TEST_DEALS     200
+#define TEST_MAX_MOVES 400
+#define MAX_POSITIONS  (TEST_DEALS * (TEST_MAX_MOVES+1))
+
+// keyframes are written this often in the replay test, so that seeking
+// starts from many of them
+#define TEST_KEYFRAME_INTERVAL 8
+
+// a test: "run" returns whether it passed, printing what went wrong if not
+typedef struct {
+    const char *name;
+    bool (*run)(void);
+} Test;
+
+// a position, and its canonical form and hash
+typedef struct {
+    uint64_t hash;
+    PackedBoard canonical;
+} HashedPosition;
+
+bool parse_args(int argc, char *argv[], const char **filter);
+bool random_move(const Board *board, Rng *rng, Move *move);
+Board permute_stacks(const Board *board, Rng *rng);
+bool test_zobrist(void);
+bool test_canonical_hash(void);
+bool test_journal(void);
+bool test_packed_is_valid(void);
+bool test_replay(void);
+
+const Test tests[] = {
+    { "zobrist",         test_zobrist },
+    { "canonical_hash",  test_canonical_hash },
+    { "journal",         test_journal },
+    { "packed_is_valid", test_packed_is_valid },
+    { "replay",          test_replay }
+};
+#define NUM_TESTS (sizeof(tests) / sizeof(tests[0]))
+
+int main(int argc, char *argv[]) {
+    const char *filter = NULL;
+    if (!parse_args(argc, argv, &filter)) {
+        fprintf(stderr, "usage: %s [--filter NAME]\n", argv[0]);
+        return 1;
+    }
+
+    unsigned int run = 0, failed = 0;
+    for (unsigned int i = 0; i < NUM_TESTS; i++) {
+        if (filter && !strstr(tests[i].name, filter)) {
+            continue;
+        }
+        bool passed = tests[i].run();
+        printf("%-24s %s\n", tests[i].name, passed ? "ok" : "FAILED");
+        run++;
+        failed += !passed;
+    }
+    printf("%u of %u tests passed\n", run - failed, run);
+    return failed ? 1 : 0;
+}
+
+// reads the command line options. Returns false if they are not valid.
+bool parse_args(int argc, char *argv[], const char **filter) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--filter") == 0 && i+1 < argc) {
+            *filter = argv[++i];
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// picks a random legal move, flips included. Returns false if there are none.
+bool random_move(const Board *board, Rng *rng, Move *move) {
+    const Policy *policy = get_policy_functions()->find("random");
+    PackedBoard packed = get_packed_functions()->pack(board);
+    Move moves[MAX_MOVES];
+    unsigned int num_moves = get_move_gen_functions()->generate(&packed, moves);
+    if (num_moves == 0) {
+        return false;
+    }
+    *move = moves[policy->choose(&packed, moves, num_moves, rng)];
+    return true;
+}
+
+// shuffles which working stack and which solution stack each stack is in,
+// giving a position that only differs by where its stacks are
+Board permute_stacks(const Board *board, Rng *rng) {
+    const RandomFunctions *rfuncs = get_random_functions();
+    Board permuted = *board;
+    for (int i = NUM_WORKING_STACKS-1; i > 0; i--) {
+        unsigned int j = rfuncs->below(rng, i+1);
+        CardStack stack = permuted.working_stacks[i];
+        permuted.working_stacks[i] = permuted.working_stacks[j];
+        permuted.working_stacks[j] = stack;
+    }
+    for (int i = NUM_SOLUTION_STACKS-1; i > 0; i--) {
+        unsigned int j = rfuncs->below(rng, i+1);
+        CardStack stack = permuted.solution_stacks[i];
+        permuted.solution_stacks[i] = permuted.solution_stacks[j];
+        permuted.solution_stacks[j] = stack;
+    }
+    return permuted;
+}
+
+// checks that the hashes kept up to date move by move always match hashing
+// the whole board again, also after unpacking, cycling through the deck and
+// undoing every move
+bool test_zobrist(void) {
+    const BoardFunctions   *bfuncs = get_board_functions();
+    const JournalFunctions *jfuncs = get_journal_functions();
+    const PackedFunctions  *pfuncs = get_packed_functions();
+    const ZobristFunctions *zfuncs = get_zobrist_functions();
+    static uint64_t hashes[TEST_MAX_MOVES];
+
+    for (uint64_t deal = 1; deal <= TEST_DEALS; deal++) {
+        Board board = bfuncs->fresh_board();
+        bfuncs->deal(&board, deal);
+        if (!zfuncs->is_consistent(&board) || zfuncs->board_hash(&board) != zfuncs->rehash_board(&board)) {
+            fprintf(stderr, "zobrist: deal %" PRIu64 " is dealt with the wrong hash\n", deal);
+            return false;
+        }
+        Journal journal = jfuncs->fresh_journal();
+        Rng rng;
+        get_random_functions()->seed(&rng, deal);
+        unsigned int num_moves = 0;
+        Move move;
+        while (num_moves < TEST_MAX_MOVES && random_move(&board, &rng, &move)) {
+            hashes[num_moves++] = zfuncs->board_hash(&board);
+            jfuncs->apply_move(&journal, &board, move);
+            PackedBoard packed = pfuncs->pack(&board);
+            Board unpacked = pfuncs->unpack(&packed);
+            if (zfuncs->board_hash(&board) != zfuncs->rehash_board(&board)
+                    || zfuncs->board_hash(&unpacked) != zfuncs->board_hash(&board)) {
+                fprintf(stderr, "zobrist: deal %" PRIu64 " has the wrong hash after move %u\n", deal, num_moves);
+                jfuncs->free(&journal);
+                return false;
+            }
+        }
+        // flipping through the whole deck comes back to the same position
+        if (!PASS_LIMIT && DRAW_COUNT == 1 && board.deck.num_cards_discard > 0) {
+            Board cycled = board;
+            unsigned int total = board.deck.num_cards + board.deck.num_cards_discard;
+            for (unsigned int i = 0; i < total; i++) {
+                bfuncs->apply_move(&cycled, (Move){ .type=MOVE_FLIP });
+            }
+            if (zfuncs->board_hash(&cycled) != zfuncs->board_hash(&board)) {
+                fprintf(stderr, "zobrist: deal %" PRIu64 " changes hash cycling the deck\n", deal);
+                jfuncs->free(&journal);
+                return false;
+            }
+        }
+        while (num_moves > 0) {
+            jfuncs->undo(&journal, &board);
+            if (zfuncs->board_hash(&board) != hashes[--num_moves]) {
+                fprintf(stderr, "zobrist: deal %" PRIu64 " has the wrong hash undoing move %u\n", deal, num_moves+1);
+                jfuncs->free(&journal);
+                return false;
+            }
+        }
+        jfuncs->free(&journal);
+    }
+    return true;
+}
+
+// sorts positions by hash to find collisions
+static int compare_hashes(const void *a, const void *b) {
+    uint64_t x = ((const HashedPosition *)a)->hash, y = ((const HashedPosition *)b)->hash;
+    return (x > y) - (x < y);
+}
+// checks that positions differing only by where their stacks are have the
+// same canonical form and hash, worked out from a board or a packed board,
+// and that no two different canonical forms share a hash
+bool test_canonical_hash(void) {
+    const BoardFunctions   *bfuncs = get_board_functions();
+    const PackedFunctions  *pfuncs = get_packed_functions();
+    const ZobristFunctions *zfuncs = get_zobrist_functions();
+    HashedPosition *positions = malloc(sizeof(HashedPosition) * MAX_POSITIONS);
+    if (positions == NULL) {
+        fprintf(stderr, "canonical_hash: out of memory\n");
+        return false;
+    }
+    unsigned int num_positions = 0;
+
+    bool ok = true;
+    for (uint64_t deal = 1; deal <= TEST_DEALS && ok; deal++) {
+        Board board = bfuncs->fresh_board();
+        bfuncs->deal(&board, deal);
+        Rng rng;
+        get_random_functions()->seed(&rng, deal);
+        Move move;
+        for (unsigned int i = 0; ok; i++) {
+            PackedBoard packed = pfuncs->pack(&board);
+            PackedBoard canonical = pfuncs->canonicalize(&packed);
+            PackedBoard twice = pfuncs->canonicalize(&canonical);
+            Board unpacked = pfuncs->unpack(&canonical);
+            uint64_t hash = zfuncs->canonical_hash(&packed);
+            ok = memcmp(&canonical, &twice, sizeof(PackedBoard)) == 0
+                && zfuncs->canonical_hash(&canonical) == hash
+                && zfuncs->canonical_board_hash(&board) == hash
+                && zfuncs->canonical_board_hash(&unpacked) == hash;
+            for (int j = 0; j < 3 && ok; j++) {
+                Board permuted = permute_stacks(&board, &rng);
+                PackedBoard permuted_packed = pfuncs->pack(&permuted);
+                PackedBoard permuted_canonical = pfuncs->canonicalize(&permuted_packed);
+                ok = memcmp(&permuted_canonical, &canonical, sizeof(PackedBoard)) == 0
+                    && zfuncs->canonical_hash(&permuted_packed) == hash
+                    && zfuncs->canonical_board_hash(&permuted) == hash;
+            }
+            if (!ok) {
+                fprintf(stderr, "canonical_hash: deal %" PRIu64 " differs after move %u\n", deal, i);
+                break;
+            }
+            positions[num_positions++] = (HashedPosition){ hash, canonical };
+            if (i == TEST_MAX_MOVES || !random_move(&board, &rng, &move)) {
+                break;
+            }
+            bfuncs->apply_move(&board, move);
+        }
+    }
+
+    qsort(positions, num_positions, sizeof(HashedPosition), compare_hashes);
+    for (unsigned int i = 1; i < num_positions && ok; i++) {
+        if (positions[i].hash == positions[i-1].hash
+                && memcmp(&positions[i].canonical, &positions[i-1].canonical, sizeof(PackedBoard)) != 0) {
+            fprintf(stderr, "canonical_hash: two positions share the hash %016" PRIx64 "\n", positions[i].hash);
+            ok = false;
+        }
+    }
+    free(positions);
+    return ok;
+}
+
+// checks that the packed rules agree with the board rules move by move, and
+// that undoing every move gets back the deal and redoing them the end
+bool test_journal(void) {
+    const BoardFunctions   *bfuncs = get_board_functions();
+    const JournalFunctions *jfuncs = get_journal_functions();
+    const PackedFunctions  *pfuncs = get_packed_functions();
+
+    for (uint64_t deal = 1; deal <= TEST_DEALS; deal++) {
+        Board board = bfuncs->fresh_board();
+        bfuncs->deal(&board, deal);
+        PackedBoard start = pfuncs->pack(&board);
+        PackedBoard packed = start;
+        Journal journal = jfuncs->fresh_journal();
+        Rng rng;
+        get_random_functions()->seed(&rng, deal);
+        bool ok = true;
+        Move move;
+        for (unsigned int i = 0; i < TEST_MAX_MOVES && ok && random_move(&board, &rng, &move); i++) {
+            Move moves[MAX_MOVES];
+            unsigned int num_moves = get_move_gen_functions()->generate(&packed, moves);
+            for (unsigned int j = 0; j < num_moves && ok; j++) {
+                ok = bfuncs->is_legal(&board, moves[j]) == pfuncs->is_legal(&packed, moves[j]);
+            }
+            jfuncs->apply_move(&journal, &board, move);
+            pfuncs->apply_move(&packed, move);
+            PackedBoard repacked = pfuncs->pack(&board);
+            ok = ok && memcmp(&repacked, &packed, sizeof(PackedBoard)) == 0;
+            if (!ok) {
+                fprintf(stderr, "journal: deal %" PRIu64 " differs from the packed rules at move %u\n", deal, i+1);
+            }
+        }
+        PackedBoard end = pfuncs->pack(&board);
+        while (ok && jfuncs->undo(&journal, &board)) {
+            continue;
+        }
+        PackedBoard undone = pfuncs->pack(&board);
+        if (ok && memcmp(&undone, &start, sizeof(PackedBoard)) != 0) {
+            fprintf(stderr, "journal: deal %" PRIu64 " is not dealt again undoing every move\n", deal);
+            ok = false;
+        }
+        while (ok && jfuncs->redo(&journal, &board)) {
+            continue;
+        }
+        PackedBoard redone = pfuncs->pack(&board);
+        if (ok && memcmp(&redone, &end, sizeof(PackedBoard)) != 0) {
+            fprintf(stderr, "journal: deal %" PRIu64 " does not end the same redoing every move\n", deal);
+            ok = false;
+        }
+        jfuncs->free(&journal);
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// checks that every position played is a valid packed board, and that
+// packed boards with a card too many, a card twice or a broken solution
+// stack are not
+bool test_packed_is_valid(void) {
+    const BoardFunctions  *bfuncs = get_board_functions();
+    const PackedFunctions *pfuncs = get_packed_functions();
+
+    for (uint64_t deal = 1; deal <= TEST_DEALS; deal++) {
+        Board board = bfuncs->fresh_board();
+        bfuncs->deal(&board, deal);
+        Rng rng;
+        get_random_functions()->seed(&rng, deal);
+        Move move;
+        for (unsigned int i = 0; ; i++) {
+            PackedBoard packed = pfuncs->pack(&board);
+            PackedBoard canonical = pfuncs->canonicalize(&packed);
+            if (!pfuncs->is_valid(&packed) || !pfuncs->is_valid(&canonical)) {
+                fprintf(stderr, "packed_is_valid: deal %" PRIu64 " is not valid after move %u\n", deal, i);
+                return false;
+            }
+            if (i == TEST_MAX_MOVES || !random_move(&board, &rng, &move)) {
+                break;
+            }
+            bfuncs->apply_move(&board, move);
+        }
+    }
+
+    Board board = bfuncs->fresh_board();
+    bfuncs->deal(&board, 1);
+    PackedBoard dealt = pfuncs->pack(&board);
+    PackedBoard broken[6];
+    for (int i = 0; i < 6; i++) {
+        broken[i] = dealt;
+    }
+    broken[0].cards[1] = broken[0].cards[0];
+    broken[1].num_cards[PACKED_WORKING_0 + NUM_WORKING_STACKS-1]++;
+    broken[2].num_cards[PACKED_DECK] = NUM_CARDS+1;
+    broken[3].cards[0] = NUM_CARDS;
+    broken[4].solution[0] = 1 << PACKED_SOLUTION_SUIT_SHIFT;
+    memset(&broken[5], 0xff, sizeof(PackedBoard));
+    for (int i = 0; i < 6; i++) {
+        if (pfuncs->is_valid(&broken[i])) {
+            fprintf(stderr, "packed_is_valid: broken board %d is taken as valid\n", i);
+            return false;
+        }
+    }
+    return true;
+}
+
+// checks that a replay written as a game is played seeks to exactly the
+// position after each move, and that a replay with a broken keyframe can't
+// be seeked past it
+bool test_replay(void) {
+    const BoardFunctions   *bfuncs = get_board_functions();
+    const PackedFunctions  *pfuncs = get_packed_functions();
+    const ReplayFunctions  *rfuncs = get_replay_functions();
+    static PackedBoard positions[TEST_MAX_MOVES+1];
+
+    for (uint64_t deal = 1; deal <= TEST_DEALS; deal++) {
+        FILE *file = tmpfile();
+        ReplayWriter writer;
+        if (file == NULL || !rfuncs->open_writer(&writer, file, deal, TEST_KEYFRAME_INTERVAL)) {
+            fprintf(stderr, "replay: could not write a replay\n");
+            if (file) {
+                fclose(file);
+            }
+            return false;
+        }
+        Board board = bfuncs->fresh_board();
+        bfuncs->deal(&board, deal);
+        Rng rng;
+        get_random_functions()->seed(&rng, deal);
+        uint32_t num_moves = 0;
+        positions[0] = pfuncs->pack(&board);
+        bool ok = true;
+        Move move;
+        while (ok && num_moves < TEST_MAX_MOVES && random_move(&board, &rng, &move)) {
+            ok = rfuncs->record(&writer, move);
+            bfuncs->apply_move(&board, move);
+            positions[++num_moves] = pfuncs->pack(&board);
+        }
+        ok = rfuncs->close_writer(&writer) && ok;
+
+        long size = ftell(file);
+        uint8_t *data = size > 0 ? malloc(size) : NULL;
+        rewind(file);
+        ok = ok && data && fread(data, size, 1, file) == 1;
+        fclose(file);
+        Replay replay;
+        if (!ok || !rfuncs->open(&replay, data, size) || replay.num_moves != num_moves) {
+            fprintf(stderr, "replay: deal %" PRIu64 " could not be read back\n", deal);
+            free(data);
+            return false;
+        }
+        for (uint32_t i = 0; i <= num_moves && ok; i++) {
+            Board seeked;
+            ok = rfuncs->seek(&replay, i, &seeked);
+            PackedBoard packed = pfuncs->pack(&seeked);
+            if (!ok || memcmp(&packed, &positions[i], sizeof(PackedBoard)) != 0) {
+                fprintf(stderr, "replay: deal %" PRIu64 " seeks to the wrong position for move %" PRIu32 "\n", deal, i);
+                ok = false;
+            }
+        }
+        // a broken keyframe stops seeking to any move after it
+        if (ok && replay.num_keyframes > 0) {
+            const uint8_t *index = replay.index;
+            uint32_t offset = index[0] | index[1] << 8 | index[2] << 16 | (uint32_t)index[3] << 24;
+            memset(data + offset, 0xff, REPLAY_KEYFRAME_SIZE);
+            Board seeked;
+            if (rfuncs->seek(&replay, TEST_KEYFRAME_INTERVAL, &seeked)) {
+                fprintf(stderr, "replay: deal %" PRIu64 " seeks past a broken keyframe\n", deal);
+                ok = false;
+            }
+        }
+        free(data);
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
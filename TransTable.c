@@ -0,0 +1,67 @@
+#include "TransTable.h"
+#include "Arena.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+bool init_trans_table(TransTable *, unsigned int size_bits);
+bool init_trans_table_in_arena(TransTable *, Arena *, unsigned int size_bits);
+void free_trans_table(TransTable *);
+bool insert_hash(TransTable *, uint64_t hash);
+
+const TransTableFunctions trans_table_functions = {
+    .init=init_trans_table,
+    .init_in_arena=init_trans_table_in_arena,
+    .free=free_trans_table,
+    .insert=insert_hash
+};
+
+// how many slots are tried before giving up on recording a hash
+#define MAX_PROBES 8
+
+// returns pointer to the handler for transposition table functions
+const TransTableFunctions *get_trans_table_functions() {
+    return &trans_table_functions;
+}
+
+// allocates an empty table of 2^size_bits entries. Returns false if out of memory.
+bool init_trans_table(TransTable *table, unsigned int size_bits) {
+    table->entries = calloc(1UL << size_bits, sizeof(uint64_t));
+    table->mask = (1UL << size_bits) - 1;
+    return table->entries != NULL;
+}
+// takes an empty table of 2^size_bits entries from an arena. Returns false if
+// the arena is full.
+bool init_trans_table_in_arena(TransTable *table, Arena *arena, unsigned int size_bits) {
+    table->entries = get_arena_functions()->alloc_zeroed(arena, sizeof(uint64_t) << size_bits);
+    table->mask = (1UL << size_bits) - 1;
+    return table->entries != NULL;
+}
+// frees the entries of the table
+void free_trans_table(TransTable *table) {
+    free(table->entries);
+    table->entries = NULL;
+}
+// records a hash. Returns false if it was already recorded, by any thread.
+bool insert_hash(TransTable *table, uint64_t hash) {
+    // zero marks an empty slot
+    if (hash == 0) {
+        hash = 1;
+    }
+    for (uint64_t i = 0; i < MAX_PROBES; i++) {
+        _Atomic uint64_t *slot = &table->entries[(hash + i) & table->mask];
+        uint64_t seen = atomic_load_explicit(slot, memory_order_relaxed);
+        if (seen == 0) {
+            // on failure "seen" is what another thread put there first
+            if (atomic_compare_exchange_strong_explicit(slot, &seen, hash,
+                    memory_order_relaxed, memory_order_relaxed)) {
+                return true;
+            }
+        }
+        if (seen == hash) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,28 @@
+#ifndef __TRANS_TABLE_H__
+#define __TRANS_TABLE_H__
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "Arena.h"
+
+// a set of position hashes that have already been searched, kept in a fixed
+// size open addressed table. Once full, new positions are no longer recorded.
+// Entries are claimed with compare-and-swap, so any number of threads can
+// share a table without locking. A table made in an arena goes away with the
+// arena, and is not freed on its own.
+typedef struct {
+    _Atomic uint64_t *entries;
+    uint64_t mask;
+} TransTable;
+
+// handler struct for all functions related to transposition tables
+typedef struct {
+    bool (*init)(TransTable *, unsigned int size_bits);
+    bool (*init_in_arena)(TransTable *, Arena *, unsigned int size_bits);
+    void (*free)(TransTable *);
+    bool (*insert)(TransTable *, uint64_t hash);
+} TransTableFunctions;
+
+const TransTableFunctions *get_trans_table_functions();
+
+#endif /* __TRANS_TABLE_H__ */
@@ -0,0 +1,191 @@
+#include "Zobrist.h"
+#include "Board.h"
+#include "Card.h"
+#include "Deck.h"
+#include "GameState.h"
+#include "Packed.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+uint64_t zobrist_key(unsigned int location, unsigned int depth, PackedCard);
+uint64_t zobrist_hash(const PackedBoard *);
+uint64_t zobrist_stack_hash(const CardStack *);
+uint64_t zobrist_deck_hash(const Deck *);
+uint64_t zobrist_board_hash(const Board *);
+uint64_t zobrist_rehash_board(const Board *);
+bool zobrist_is_consistent(const Board *);
+uint64_t zobrist_canonical_hash(const PackedBoard *);
+uint64_t zobrist_canonical_board_hash(const Board *);
+
+const ZobristFunctions zobrist_functions = {
+    .key=zobrist_key,
+    .hash=zobrist_hash,
+    .stack_hash=zobrist_stack_hash,
+    .deck_hash=zobrist_deck_hash,
+    .board_hash=zobrist_board_hash,
+    .rehash_board=zobrist_rehash_board,
+    .is_consistent=zobrist_is_consistent,
+    .canonical_hash=zobrist_canonical_hash,
+    .canonical_board_hash=zobrist_canonical_board_hash
+};
+
+// returns pointer to the handler for zobrist functions
+const ZobristFunctions *get_zobrist_functions() {
+    return &zobrist_functions;
+}
+
+// returns the key for a card at the given depth of a location: a segment of a
+// packed board, or a solution stack. Keys are mixed from the inputs rather
+// than looked up, so there is no table to fill in or keep in cache.
+uint64_t zobrist_key(unsigned int location, unsigned int depth, PackedCard card) {
+    return zobrist_mix(location, depth, card);
+}
+
+// hashes a whole packed board from scratch
+uint64_t zobrist_hash(const PackedBoard *packed) {
+    uint64_t hash = 0;
+    unsigned int n = 0;
+    for (int segment = 0; segment < NUM_PACKED_SEGMENTS; segment++) {
+        for (unsigned int depth = 0; depth < packed->num_cards[segment]; depth++) {
+            hash ^= zobrist_key(segment, depth, packed->cards[n++]);
+        }
+    }
+    for (int i = 0; i < NUM_SOLUTION_STACKS; i++) {
+        if (packed->solution[i]) {
+            hash ^= zobrist_key(ZOBRIST_SOLUTION_0+i, 0, packed->solution[i]);
+        }
+    }
+#if PASS_LIMIT
+    hash ^= zobrist_key(ZOBRIST_PASSES, 0, packed->passes);
+#endif
+    return hash;
+}
+
+// hashes the cards of a stack from scratch, as the stack operations keep it
+uint64_t zobrist_stack_hash(const CardStack *stack) {
+    uint64_t hash = 0;
+    for (unsigned int i = 0; i < stack->num_cards; i++) {
+        hash ^= zobrist_card_key(ZOBRIST_STACK, i, stack->cards[i]);
+    }
+    return hash;
+}
+
+// hashes the deck and discard pile from scratch, as the deck operations keep
+// it. These are the same keys a packed board uses for them.
+uint64_t zobrist_deck_hash(const Deck *deck) {
+    uint64_t hash = 0;
+    for (unsigned int i = 0; i < deck->num_cards; i++) {
+        hash ^= zobrist_card_key(PACKED_DECK, i, deck->cards[i]);
+    }
+    for (unsigned int i = 0; i < deck->num_cards_discard; i++) {
+        hash ^= zobrist_card_key(PACKED_DISCARD, i, deck->discard[i]);
+    }
+#if PASS_LIMIT
+    hash ^= zobrist_key(ZOBRIST_PASSES, 0, deck->passes);
+#endif
+    return hash;
+}
+
+// rotates a hash left by "bits", which is from 1 to 63
+static uint64_t rotate(uint64_t hash, unsigned int bits) {
+    return hash << bits | hash >> (64-bits);
+}
+
+// hashes a board from the hashes its stacks and deck carry. Rotating a hash
+// rotates each of its keys, so this is still the xor of one key per card.
+uint64_t zobrist_board_hash(const Board *board) {
+    uint64_t hash = board->deck.hash;
+    for (int i = 0; i < NUM_SOLUTION_STACKS; i++) {
+        hash ^= rotate(board->solution_stacks[i].hash, ZOBRIST_ROTATION(SOLUTION_0+i));
+    }
+    for (int i = 0; i < NUM_WORKING_STACKS; i++) {
+        hash ^= rotate(board->working_stacks[i].hash, ZOBRIST_ROTATION(WORKING_0+i));
+    }
+    return hash;
+}
+
+// hashes a board from its cards, ignoring the hashes it carries
+uint64_t zobrist_rehash_board(const Board *board) {
+    uint64_t hash = zobrist_deck_hash(&board->deck);
+    for (int i = 0; i < NUM_SOLUTION_STACKS; i++) {
+        hash ^= rotate(zobrist_stack_hash(&board->solution_stacks[i]), ZOBRIST_ROTATION(SOLUTION_0+i));
+    }
+    for (int i = 0; i < NUM_WORKING_STACKS; i++) {
+        hash ^= rotate(zobrist_stack_hash(&board->working_stacks[i]), ZOBRIST_ROTATION(WORKING_0+i));
+    }
+    return hash;
+}
+
+// returns whether or not every hash the board carries matches its cards
+bool zobrist_is_consistent(const Board *board) {
+    if (board->deck.hash != zobrist_deck_hash(&board->deck)) {
+        return false;
+    }
+    for (int i = 0; i < NUM_SOLUTION_STACKS; i++) {
+        if (board->solution_stacks[i].hash != zobrist_stack_hash(&board->solution_stacks[i])) {
+            return false;
+        }
+    }
+    for (int i = 0; i < NUM_WORKING_STACKS; i++) {
+        if (board->working_stacks[i].hash != zobrist_stack_hash(&board->working_stacks[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// scrambles the hash of a working stack before it goes into a canonical hash.
+// The stacks' hashes are added up so their order does not matter, and
+// scrambling them first keeps cards in different stacks from being mistaken
+// for cards in the same one.
+static uint64_t scramble(uint64_t hash) {
+    hash = (hash ^ (hash >> 33)) * 0xff51afd7ed558ccdULL;
+    hash = (hash ^ (hash >> 33)) * 0xc4ceb9fe1a85ec53ULL;
+    return hash ^ (hash >> 33);
+}
+// returns the key of a solution stack in a canonical hash. A solution stack's
+// byte holds its suit, so the same key is used whichever slot it is in.
+static uint64_t canonical_solution_key(uint8_t solution) {
+    return solution ? zobrist_key(ZOBRIST_SOLUTION_0, 0, solution) : 0;
+}
+
+// hashes a packed board from scratch so that it matches every board it is
+// the same as but for the order of the working stacks and solution stacks
+uint64_t zobrist_canonical_hash(const PackedBoard *packed) {
+    uint64_t hash = 0, working = 0;
+    unsigned int n = 0;
+    for (int segment = 0; segment < PACKED_WORKING_0; segment++) {
+        for (unsigned int depth = 0; depth < packed->num_cards[segment]; depth++) {
+            hash ^= zobrist_key(segment, depth, packed->cards[n++]);
+        }
+    }
+    for (int segment = PACKED_WORKING_0; segment < NUM_PACKED_SEGMENTS; segment++) {
+        uint64_t stack = 0;
+        for (unsigned int depth = 0; depth < packed->num_cards[segment]; depth++) {
+            stack ^= zobrist_key(ZOBRIST_STACK, depth, packed->cards[n++]);
+        }
+        working += scramble(stack);
+    }
+    for (int i = 0; i < NUM_SOLUTION_STACKS; i++) {
+        hash ^= canonical_solution_key(packed->solution[i]);
+    }
+#if PASS_LIMIT
+    hash ^= zobrist_key(ZOBRIST_PASSES, 0, packed->passes);
+#endif
+    return hash ^ working;
+}
+
+// the same as zobrist_canonical_hash, from the hashes a board carries
+uint64_t zobrist_canonical_board_hash(const Board *board) {
+    uint64_t hash = board->deck.hash, working = 0;
+    for (int i = 0; i < NUM_WORKING_STACKS; i++) {
+        working += scramble(board->working_stacks[i].hash);
+    }
+    for (int i = 0; i < NUM_SOLUTION_STACKS; i++) {
+        const CardStack *stack = &board->solution_stacks[i];
+        if (stack->num_cards) {
+            hash ^= canonical_solution_key(stack->num_cards | stack->cards[0].suit << PACKED_SOLUTION_SUIT_SHIFT);
+        }
+    }
+    return hash ^ working;
+}
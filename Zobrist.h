@@ -0,0 +1,63 @@
+#ifndef __ZOBRIST_H__
+#define __ZOBRIST_H__
+#include <stdbool.h>
+#include <stdint.h>
+#include "Board.h"
+#include "Card.h"
+#include "Deck.h"
+#include "Packed.h"
+
+// zobrist locations past the card segments of a packed board, one per solution
+// stack, then one for the number of passes through the deck
+#define ZOBRIST_SOLUTION_0 NUM_PACKED_SEGMENTS
+#define ZOBRIST_PASSES     (ZOBRIST_SOLUTION_0+NUM_SOLUTION_STACKS)
+// the location for cards in a solution or working stack in the hash a stack
+// carries. It is the same for every stack, so the hash says nothing about
+// which stack it is; the board hash tells them apart by rotating each one.
+#define ZOBRIST_STACK      (ZOBRIST_PASSES+1)
+
+// how far the hash of the stack at a spot is rotated in a board hash
+#define ZOBRIST_ROTATION(spot) (5*((spot)+1))
+
+// mixes a location, a depth and a card into a key
+static inline uint64_t zobrist_mix(unsigned int location, unsigned int depth, PackedCard card) {
+    uint64_t z = ((uint64_t)location << 16 | depth << 8 | card) * 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+// returns the key for a card at the given depth of a location, as the stack
+// and deck operations keep their hashes with it
+static inline uint64_t zobrist_card_key(unsigned int location, unsigned int depth, Card card) {
+    return zobrist_mix(location, depth, (card.suit * NUM_VALUES + card.value) | (card.is_visible ? PACKED_VISIBLE : 0));
+}
+
+// handler struct for zobrist hashing of positions. A position's hash is the
+// xor of one key per card, so it can be updated as cards move.
+//
+// Besides hashing packed boards, every CardStack and Deck carries the hash of
+// its own cards, which the stack and deck operations keep up to date as cards
+// move, so a Board can be hashed without looking at its cards. "board_hash"
+// combines the hashes a board carries, and "rehash_board" hashes it from
+// scratch; they always agree. "is_consistent" checks every stack and the
+// deck, and is asserted after each move in debug builds.
+//
+// The canonical hashes are the same for boards that differ only in the order
+// of the working stacks or in which solution stack holds which suit, as the
+// game plays the same from all of them (see PackedFunctions.canonicalize).
+// The two agree for a board and its packed form.
+typedef struct {
+    uint64_t (*key)(unsigned int location, unsigned int depth, PackedCard);
+    uint64_t (*hash)(const PackedBoard *);
+    uint64_t (*stack_hash)(const CardStack *);
+    uint64_t (*deck_hash)(const Deck *);
+    uint64_t (*board_hash)(const Board *);
+    uint64_t (*rehash_board)(const Board *);
+    bool (*is_consistent)(const Board *);
+    uint64_t (*canonical_hash)(const PackedBoard *);
+    uint64_t (*canonical_board_hash)(const Board *);
+} ZobristFunctions;
+
+const ZobristFunctions *get_zobrist_functions();
+
+#endif /* __ZOBRIST_H__ */